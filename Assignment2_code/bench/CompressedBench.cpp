@@ -0,0 +1,119 @@
+/**
+ * @file CompressedBench.cpp
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Compressed input benchmark: decompression overlapped with parsing against doing both in turn.
+ *
+ * Build from the Assignment2_code folder (drop the zstd flags if libzstd is not installed):
+ *   g++ -std=c++17 -O2 -pthread -DWEATHER_ZLIB -DWEATHER_ZSTD -Iinclude bench/CompressedBench.cpp
+ *       src/[A-Za-z]*.cpp -lz -lzstd -o compressed_bench
+ *
+ * Usage: compressed_bench plain.csv packed.csv.gz|packed.csv.zst [repeats]
+ * (packed must hold the same text as plain, repeats defaults to 5)
+ *
+ * Times draining the decompressor alone, parsing the plain file alone and
+ * the streamed load of the packed file, then checks the streamed load gave
+ * the same rows as the plain one. Without overlap the streamed load would
+ * take about decompress + parse.
+ */
+
+#include "CompressedReader.h"
+#include "FileHandler.h"
+#include "WeatherLog.h"
+#include "BST.h"
+#include "MonthTable.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+//best time in seconds over the repeats
+template<typename Work>
+static double bestTime(Work work, int repeats) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        work();
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        if (took.count() < best) best = took.count();
+    }
+    return best;
+}
+
+//same value, NaN counts as equal to NaN
+static bool sameFloat(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+//row for row comparison of two loaded tables
+static bool sameData(const MonthTable<WeatherLog>& a, const MonthTable<WeatherLog>& b) {
+    if (a.GetCount() != b.GetCount()) return false;
+    bool same = true;
+    a.forEach([&](int key, const WeatherLog& logA) {
+        const WeatherLog* logB = b.find(key);
+        if (!same || !logB || logA.GetSize() != logB->GetSize()) {
+            same = false;
+            return;
+        }
+        for (int i = 0; i < logA.GetSize() && same; i++) {
+            WeatherEntry x = logA[i], y = (*logB)[i];
+            if (x.minutes != y.minutes || !sameFloat(x.windSpeed, y.windSpeed) ||
+                !sameFloat(x.temperature, y.temperature) || !sameFloat(x.solarRadiation, y.solarRadiation))
+                same = false;
+        }
+    });
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " plain.csv packed.csv.gz|packed.csv.zst [repeats]" << std::endl;
+        return 2;
+    }
+    std::string plain = argv[1], packed = argv[2];
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+    if (repeats < 1) repeats = 1;
+
+    double mb = 0;
+    bool readOk = true;
+    double inflateSec = bestTime([&]() {
+        CompressedReader reader;
+        std::string block;
+        double bytes = 0;
+        readOk = reader.open(packed);
+        while (readOk && reader.read(block)) bytes += block.size();
+        if (reader.Failed() || !readOk) {
+            std::cerr << reader.GetError() << packed << std::endl;
+            readOk = false;
+        }
+        mb = bytes / (1024.0 * 1024.0);
+    }, repeats);
+    if (!readOk) return 1;
+
+    MonthTable<WeatherLog> plainMap, packedMap;
+    double parseSec = bestTime([&]() {
+        BST<int> tree;
+        plainMap.Clear();
+        FileHandler::parseCSV(plain, tree, plainMap);
+    }, repeats);
+    double streamSec = bestTime([&]() {
+        BST<int> tree;
+        packedMap.Clear();
+        FileHandler::parseCompressedCSV(packed, tree, packedMap, CORE_FIELDS);
+    }, repeats);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Input: " << mb << " MB of text, best of " << repeats << "\n";
+    std::cout << "decompress only:     " << inflateSec * 1000 << " ms, " << mb / inflateSec << " MB/s\n";
+    std::cout << "parse plain only:    " << parseSec * 1000 << " ms, " << mb / parseSec << " MB/s\n";
+    std::cout << "one after the other: " << (inflateSec + parseSec) * 1000 << " ms (sum of the two)\n";
+    std::cout << "streamed load:       " << streamSec * 1000 << " ms, " << mb / streamSec << " MB/s ("
+              << (inflateSec + parseSec) / streamSec << "x of one after the other)\n";
+
+    bool same = sameData(plainMap, packedMap);
+    std::cout << "Results match: " << (same ? "yes" : "NO") << "\n";
+    return same ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file DecimalCheck.cpp
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Compares FastParse's scanDecimal with std::strtof on millions of generated cells.
+ *
+ * Build from the Assignment2_code folder:
+ *   g++ -std=c++17 -O2 -Iinclude bench/DecimalCheck.cpp src/[A-Za-z]*.cpp -o decimal_check
+ *
+ * Usage: decimal_check [inputs] [seed]
+ * (defaults to 5000000 inputs, seed 1)
+ *
+ * Half of the cells are well-formed decimals like the logger writes ("22.75",
+ * "-3.1", "664", "0.000123"), with 1 to 9 digits, a sign and a trailing blank
+ * now and then, so both the exact fast path and the strtof fallback for long
+ * digit strings are hit. The other half are random strings of digits, dots,
+ * signs, blanks, 'e' and junk. Each cell is read the way the loader used to
+ * (strtof, empty is NaN, no digits or ERANGE rejects the row) and with
+ * scanDecimal; whether the cell is accepted and the bits of the float must be
+ * the same. The first differences are printed and the exit code is 1 if
+ * there are any.
+ */
+
+#include "FastParse.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+//the rules of the old loader: empty is NaN, no digits or out of range rejects the row
+static bool referenceFloat(const std::string& cell, float& value) {
+    if (cell.empty()) {
+        value = NAN;
+        return true;
+    }
+    char* stop = NULL;
+    errno = 0;
+    value = std::strtof(cell.c_str(), &stop);
+    return stop != cell.c_str() && errno != ERANGE;
+}
+
+//a decimal the way the logger writes it, sometimes longer than the fast path takes
+static std::string wellFormed(std::mt19937& rng) {
+    std::string cell;
+    if (rng() % 4 == 0) cell += (rng() % 2) ? '-' : '+';
+    int digits = 1 + rng() % 9;
+    int point = rng() % (digits + 1);
+    for (int i = 0; i < digits; i++) {
+        if (i == point && i > 0) cell += '.';
+        cell += static_cast<char>('0' + rng() % 10);
+    }
+    if (rng() % 8 == 0) cell += (rng() % 2) ? ' ' : '\r';
+    return cell;
+}
+
+//anything at all made of number-like characters
+static std::string randomCell(std::mt19937& rng) {
+    static const char alphabet[] = "0123456789.-+ e\rx";
+    std::string cell;
+    int length = rng() % 12;
+    for (int i = 0; i < length; i++) cell += alphabet[rng() % (sizeof(alphabet) - 1)];
+    return cell;
+}
+
+int main(int argc, char* argv[]) {
+    long inputs = argc > 1 ? std::atol(argv[1]) : 5000000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atol(argv[2])) : 1;
+    std::mt19937 rng(seed);
+    long differences = 0, accepted = 0;
+    for (long n = 0; n < inputs; n++) {
+        std::string cell = n % 2 ? wellFormed(rng) : randomCell(rng);
+        float expected = 0.0f, actual = 0.0f;
+        bool expectedOk = referenceFloat(cell, expected);
+        bool actualOk = scanDecimal(cell.data(), cell.data() + cell.size(), actual) <= PARSE_EMPTY;
+        bool same = expectedOk == actualOk;
+        if (same && expectedOk && !(std::isnan(expected) && std::isnan(actual)))
+            same = std::memcmp(&expected, &actual, sizeof(float)) == 0;
+        if (expectedOk) accepted++;
+        if (same) continue;
+        if (differences++ < 10) {
+            std::cout << "\"" << cell << "\": strtof " << (expectedOk ? "accepts " : "rejects ") << expected
+                      << ", scanDecimal " << (actualOk ? "accepts " : "rejects ") << actual << std::endl;
+        }
+    }
+    std::cout << inputs << " inputs, " << accepted << " accepted, " << differences << " differences" << std::endl;
+    return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file LoaderBench.cpp
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.4
+ * @brief Loader benchmark: the original getline loader against the memory-mapped parser.
+ *
+ * Build from the Assignment2_code folder:
+ *   g++ -std=c++17 -O2 -Iinclude bench/LoaderBench.cpp src/[A-Za-z]*.cpp -o loader_bench
+ *
+ * Usage: loader_bench [repeats] [file.csv ...]
+ * (defaults to 5 repeats of data/Metdata-Jan-Dec2007.csv)
+ *
+ * The getline loader is FileHandler::parseCSVStream, the program's original
+ * loader (string splits, std::stof, Date and MyTime setters that throw on bad
+ * values), so the first two lines are the before and after of the in-place
+ * parser and the match check compares it with an independent implementation.
+ *
+ * Prints MB/s for both loaders and checks they produced the same rows, then
+ * times the memory-mapped load of all 18 columns against the default four,
+ * repeats the memory-mapped load with chunked parsing on 2, 4, ...
+ * threads up to the number of cores, and runs the pipelined loader with
+ * 1, 2, 4, ... parser workers, printing its stage wait counters.
+ */
+
+#include "FileHandler.h"
+#include "WeatherLog.h"
+#include "BST.h"
+#include "MonthTable.h"
+#include "Parallel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+//size of a file in bytes
+static double fileBytes(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    return in ? static_cast<double>(in.tellg()) : 0.0;
+}
+
+//best time in seconds over the repeats, last result kept in dataMap
+template<typename Loader>
+static double timeLoader(Loader loader, const Vector<std::string>& files, int repeats,
+                         MonthTable<WeatherLog>& dataMap) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        BST<int> tree;
+        dataMap.Clear();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < files.GetSize(); i++) loader(files[i], tree, dataMap);
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        if (took.count() < best) best = took.count();
+    }
+    return best;
+}
+
+//same value, NaN counts as equal to NaN
+static bool sameFloat(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+//row for row comparison of two loaded tables
+static bool sameData(const MonthTable<WeatherLog>& a, const MonthTable<WeatherLog>& b) {
+    if (a.GetCount() != b.GetCount()) return false;
+    bool same = true;
+    a.forEach([&](int key, const WeatherLog& logA) {
+        const WeatherLog* logB = b.find(key);
+        if (!same || !logB || logA.GetSize() != logB->GetSize()) {
+            same = false;
+            return;
+        }
+        for (int i = 0; i < logA.GetSize() && same; i++) {
+            WeatherEntry x = logA[i], y = (*logB)[i];
+            if (x.minutes != y.minutes || !sameFloat(x.windSpeed, y.windSpeed) ||
+                !sameFloat(x.temperature, y.temperature) || !sameFloat(x.solarRadiation, y.solarRadiation))
+                same = false;
+        }
+    });
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    int repeats = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (repeats < 1) repeats = 1;
+    Vector<std::string> files;
+    for (int i = 2; i < argc; i++) files.pushBack(argv[i]);
+    if (files.GetSize() == 0) files.pushBack("data/Metdata-Jan-Dec2007.csv");
+
+    double bytes = 0;
+    for (int i = 0; i < files.GetSize(); i++) bytes += fileBytes(files[i]);
+    double mb = bytes / (1024.0 * 1024.0);
+
+    MonthTable<WeatherLog> streamMap, mappedMap;
+    double streamSec = timeLoader([](const std::string& f, BST<int>& t, MonthTable<WeatherLog>& m) {
+        return FileHandler::parseCSVStream(f, t, m);
+    }, files, repeats, streamMap);
+    double mappedSec = timeLoader([](const std::string& f, BST<int>& t, MonthTable<WeatherLog>& m) {
+        return FileHandler::parseCSV(f, t, m);
+    }, files, repeats, mappedMap);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Input: " << mb << " MB in " << files.GetSize() << " file(s), best of " << repeats << "\n";
+    std::cout << "getline loader: " << streamSec * 1000 << " ms, " << mb / streamSec << " MB/s\n";
+    std::cout << "mmap loader:    " << mappedSec * 1000 << " ms, " << mb / mappedSec << " MB/s\n";
+    std::cout << "Speedup: " << streamSec / mappedSec << "x\n";
+
+    bool same = sameData(streamMap, mappedMap);
+    std::cout << "Results match: " << (same ? "yes" : "NO") << "\n";
+
+    //unused columns are only skipped over, decoding all of them shows what that saves
+    MonthTable<WeatherLog> allMap;
+    double allSec = timeLoader([](const std::string& f, BST<int>& t, MonthTable<WeatherLog>& m) {
+        return FileHandler::parseCSV(f, t, m, 1, ALL_FIELDS);
+    }, files, repeats, allMap);
+    bool allSame = sameData(streamMap, allMap);
+    std::cout << "mmap loader, all 18 columns: " << allSec * 1000 << " ms, " << mb / allSec
+              << " MB/s (4 columns are " << allSec / mappedSec << "x faster), match: " << (allSame ? "yes" : "NO") << "\n";
+    same = same && allSame;
+
+    int cores = resolveThreadCount(0);
+    for (int threads = 2; threads <= cores; threads *= 2) {
+        MonthTable<WeatherLog> chunkedMap;
+        double sec = timeLoader([threads](const std::string& f, BST<int>& t, MonthTable<WeatherLog>& m) {
+            return FileHandler::parseCSV(f, t, m, threads);
+        }, files, repeats, chunkedMap);
+        bool chunkSame = sameData(streamMap, chunkedMap);
+        std::cout << "mmap loader, " << threads << " threads: " << sec * 1000 << " ms, " << mb / sec
+                  << " MB/s (" << mappedSec / sec << "x of 1 thread), match: " << (chunkSame ? "yes" : "NO") << "\n";
+        same = same && chunkSame;
+    }
+
+    //the wait counters (summed over the repeats) show which stage holds the others up
+    for (int parsers = 1; parsers <= cores || parsers == 1; parsers *= 2) {
+        MonthTable<WeatherLog> pipedMap;
+        PipelineStats stats;
+        double sec = timeLoader([parsers, &stats](const std::string& f, BST<int>& t, MonthTable<WeatherLog>& m) {
+            return FileHandler::parseCSVPipelined(f, t, m, parsers, CORE_FIELDS, stats);
+        }, files, repeats, pipedMap);
+        bool pipedSame = sameData(streamMap, pipedMap);
+        std::cout << "pipeline, " << parsers << " parser(s): " << sec * 1000 << " ms, " << mb / sec
+                  << " MB/s (" << mappedSec / sec << "x of mmap), match: " << (pipedSame ? "yes" : "NO") << "\n";
+        FileHandler::printPipelineStats(std::cout, stats);
+        same = same && pipedSame;
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file ParseBench.cpp
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Field parsing benchmark: stringstream/stof with exceptions against the FastParse kernels.
+ *
+ * Build from the Assignment2_code folder:
+ *   g++ -std=c++17 -O2 -Iinclude bench/ParseBench.cpp src/[A-Za-z]*.cpp -o parse_bench
+ *
+ * Usage: parse_bench [dirty%] [repeats] [file.csv]
+ * (defaults to 5% dirty rows, best of 5 repeats, data/Metdata-Jan-Dec2007.csv)
+ *
+ * The WAST, S, T and SR cells of every row are collected, and the given share
+ * of rows gets a broken cell (bad date, impossible time, text in a number).
+ * Both parsers then read the same cells; the old one the way processCSVLine
+ * does (FileHandler::parseDate/parseTime and std::stof inside try/catch),
+ * the new one with scanTimestamp and scanDecimal. The accepted rows and their
+ * values must be identical.
+ */
+
+#include "CsvFields.h"
+#include "FastParse.h"
+#include "FileHandler.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+//the four cells of one row
+struct RowCells {
+    std::string stamp, wind, temp, solar;
+};
+
+//a parsed row, ok false if the row was rejected
+struct RowValues {
+    bool ok;
+    int minutes;
+    float wind, temp, solar;
+};
+
+//the old path: string splits, stream extraction, std::stof and exceptions for bad rows
+static void parseOld(const Vector<RowCells>& rows, Vector<RowValues>& out) {
+    for (int i = 0; i < rows.GetSize(); i++) {
+        const RowCells& r = rows[i];
+        RowValues v = {false, 0, 0, 0, 0};
+        try {
+            std::stringstream dts(r.stamp);
+            std::string datePart, timePart;
+            std::getline(dts, datePart, ' ');
+            std::getline(dts, timePart);
+            Date date = FileHandler::parseDate(datePart);
+            MyTime time = FileHandler::parseTime(timePart);
+            v.wind = r.wind.empty() ? NAN : std::stof(r.wind);
+            v.temp = r.temp.empty() ? NAN : std::stof(r.temp);
+            v.solar = r.solar.empty() ? NAN : std::stof(r.solar);
+            if (isStampDate(date.GetYear(), date.GetMonth(), date.GetDay())) {
+                v.minutes = toEpochMinutes(date, time);
+                v.ok = true;
+            }
+        } catch (...) {
+        }
+        out[i] = v;
+    }
+}
+
+//the new path: error codes, no allocation
+static void parseNew(const Vector<RowCells>& rows, Vector<RowValues>& out) {
+    for (int i = 0; i < rows.GetSize(); i++) {
+        const RowCells& r = rows[i];
+        RowValues v = {false, 0, 0, 0, 0};
+        const char* s = r.stamp.data();
+        const char* w = r.wind.data();
+        const char* t = r.temp.data();
+        const char* sr = r.solar.data();
+        v.ok = scanTimestamp(s, s + r.stamp.size(), v.minutes) == PARSE_OK &&
+               scanDecimal(w, w + r.wind.size(), v.wind) <= PARSE_EMPTY &&
+               scanDecimal(t, t + r.temp.size(), v.temp) <= PARSE_EMPTY &&
+               scanDecimal(sr, sr + r.solar.size(), v.solar) <= PARSE_EMPTY;
+        out[i] = v;
+    }
+}
+
+//same value, NaN counts as equal to NaN
+static bool sameFloat(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+template<typename Parser>
+static double timeParser(Parser parser, const Vector<RowCells>& rows, Vector<RowValues>& out, int repeats) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        parser(rows, out);
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        if (took.count() < best) best = took.count();
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int dirty = argc > 1 ? std::atoi(argv[1]) : 5;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::string file = argc > 3 ? argv[3] : "data/Metdata-Jan-Dec2007.csv";
+    if (repeats < 1) repeats = 1;
+
+    std::ifstream in(file);
+    std::string line;
+    if (!std::getline(in, line)) {
+        std::cerr << "Cannot read " << file << "\n";
+        return 1;
+    }
+    std::map<std::string, int> colMap = FileHandler::buildColumnMap(line);
+    if (!colMap.count("WAST") || !colMap.count("S") || !colMap.count("T") || !colMap.count("SR")) {
+        std::cerr << "Missing columns in " << file << "\n";
+        return 1;
+    }
+    int wast = colMap["WAST"], wind = colMap["S"], temp = colMap["T"], solar = colMap["SR"];
+
+    //broken cells put into every dirty row, in turn
+    const char* badStamps[3] = {"31/02/2007 9:00", "1/01/2007 25:10", "1-01-2007 9:00"};
+    const char* badNumbers[2] = {"n/a", "-"};
+    Vector<RowCells> rows;
+    Vector<FieldSlice> fields;
+    std::srand(1);
+    while (std::getline(in, line)) {
+        splitFields(line.data(), line.data() + line.size(), fields);
+        int n = fields.GetSize();
+        if (wast >= n || wind >= n || temp >= n || solar >= n) continue;
+        RowCells r;
+        r.stamp.assign(fields[wast].begin, fields[wast].end());
+        r.wind.assign(fields[wind].begin, fields[wind].end());
+        r.temp.assign(fields[temp].begin, fields[temp].end());
+        r.solar.assign(fields[solar].begin, fields[solar].end());
+        if (std::rand() % 100 < dirty) {
+            int k = std::rand() % 5;
+            if (k < 3) r.stamp = badStamps[k];
+            else r.temp = badNumbers[k - 3];
+        }
+        rows.pushBack(r);
+    }
+
+    Vector<RowValues> oldValues(rows.GetSize(), RowValues()), newValues(rows.GetSize(), RowValues());
+    double oldSec = timeParser(parseOld, rows, oldValues, repeats);
+    double newSec = timeParser(parseNew, rows, newValues, repeats);
+
+    int accepted = 0;
+    bool same = true;
+    for (int i = 0; i < rows.GetSize(); i++) {
+        const RowValues& a = oldValues[i];
+        const RowValues& b = newValues[i];
+        if (a.ok) accepted++;
+        if (a.ok != b.ok) same = false;
+        else if (a.ok && (a.minutes != b.minutes || !sameFloat(a.wind, b.wind) ||
+                          !sameFloat(a.temp, b.temp) || !sameFloat(a.solar, b.solar))) same = false;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Rows: " << rows.GetSize() << " (" << dirty << "% dirty, " << accepted << " accepted), best of " << repeats << "\n";
+    std::cout << "stringstream/stof " << oldSec * 1000 << " ms (" << oldSec * 1e9 / rows.GetSize() << " ns/row)\n";
+    std::cout << "FastParse         " << newSec * 1000 << " ms (" << newSec * 1e9 / rows.GetSize() << " ns/row), "
+              << oldSec / newSec << "x faster\n";
+    std::cout << "Results " << (same ? "match" : "DIFFER") << "\n";
+    return same ? 0 : 1;
+}
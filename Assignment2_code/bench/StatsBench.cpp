@@ -0,0 +1,116 @@
+/**
+ * @file StatsBench.cpp
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Statistics kernel benchmark: scalar against SSE2, AVX2 and AVX-512.
+ *
+ * Build from the Assignment2_code folder:
+ *   g++ -std=c++17 -O2 -Iinclude bench/StatsBench.cpp src/SimdKernels.cpp -o stats_bench
+ *
+ * Usage: stats_bench [values] [repeats]
+ * (defaults to 4000000 values, about 5% NaN, best of 20 repeats)
+ *
+ * Times nanSums and nanCrossSums on every level the CPU supports and prints
+ * the speedup over the scalar kernel and the largest relative difference of
+ * the sums from the scalar results.
+ */
+
+#include "SimdKernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+//relative difference, 0 when both are 0
+static double relDiff(double a, double b) {
+    double scale = std::fabs(a) > std::fabs(b) ? std::fabs(a) : std::fabs(b);
+    return scale > 0 ? std::fabs(a - b) / scale : 0.0;
+}
+
+static double maxDiff(const NanSums& a, const NanSums& b) {
+    double d = a.count == b.count ? 0.0 : 1.0;
+    double s = relDiff(a.sum, b.sum), q = relDiff(a.sumSq, b.sumSq);
+    if (s > d) d = s;
+    if (q > d) d = q;
+    return d;
+}
+
+static double maxDiff(const CrossSums& a, const CrossSums& b) {
+    double d = a.count == b.count ? 0.0 : 1.0;
+    double all[5] = {relDiff(a.sumX, b.sumX), relDiff(a.sumY, b.sumY), relDiff(a.sumXX, b.sumXX),
+                     relDiff(a.sumYY, b.sumYY), relDiff(a.sumXY, b.sumXY)};
+    for (int i = 0; i < 5; i++) if (all[i] > d) d = all[i];
+    return d;
+}
+
+//best time in seconds over the repeats, last result kept in result
+template<typename Kernel, typename Result>
+static double timeKernel(Kernel kernel, int repeats, Result& result) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        result = kernel();
+        std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        if (took.count() < best) best = took.count();
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (n < 1) n = 1;
+    if (repeats < 1) repeats = 1;
+
+    //wind/temperature-like values with gaps
+    float* x = new float[n];
+    float* y = new float[n];
+    std::mt19937 gen(2007);
+    std::normal_distribution<float> wind(4.0f, 2.0f), temp(18.0f, 6.0f);
+    std::uniform_real_distribution<float> gap(0.0f, 1.0f);
+    for (int i = 0; i < n; i++) {
+        x[i] = gap(gen) < 0.05f ? NAN : wind(gen);
+        y[i] = gap(gen) < 0.05f ? NAN : temp(gen);
+    }
+
+    std::cout << "Values: " << n << ", best of " << repeats << ", detected: "
+              << simdLevelName(detectSimdLevel()) << "\n";
+    std::cout << std::left << std::setw(8) << "level" << std::right
+              << std::setw(12) << "sums ms" << std::setw(10) << "speedup" << std::setw(12) << "max diff"
+              << std::setw(12) << "cross ms" << std::setw(10) << "speedup" << std::setw(12) << "max diff" << "\n";
+
+    NanSums baseSums = {0, 0.0, 0.0};
+    CrossSums baseCross = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    double baseSumsSec = 0, baseCrossSec = 0;
+    bool ok = true;
+    for (int l = SIMD_SCALAR; l <= detectSimdLevel(); l++) {
+        SimdLevel level = setSimdLevel(static_cast<SimdLevel>(l));
+        NanSums sums;
+        CrossSums cross;
+        double sumsSec = timeKernel([x, n]() { return nanSums(x, n); }, repeats, sums);
+        double crossSec = timeKernel([x, y, n]() { return nanCrossSums(x, y, n); }, repeats, cross);
+        if (level == SIMD_SCALAR) {
+            baseSums = sums;
+            baseCross = cross;
+            baseSumsSec = sumsSec;
+            baseCrossSec = crossSec;
+        }
+        double dSums = maxDiff(baseSums, sums), dCross = maxDiff(baseCross, cross);
+        ok = ok && dSums < 1e-9 && dCross < 1e-9;
+        std::cout << std::left << std::setw(8) << simdLevelName(level) << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << sumsSec * 1000
+                  << std::setprecision(2) << std::setw(9) << baseSumsSec / sumsSec << "x"
+                  << std::scientific << std::setprecision(1) << std::setw(12) << dSums << std::fixed
+                  << std::setprecision(3) << std::setw(12) << crossSec * 1000
+                  << std::setprecision(2) << std::setw(9) << baseCrossSec / crossSec << "x"
+                  << std::scientific << std::setprecision(1) << std::setw(12) << dCross << "\n";
+    }
+    std::cout << "Results agree: " << (ok ? "yes" : "NO") << "\n";
+
+    delete[] x;
+    delete[] y;
+    return ok ? 0 : 1;
+}
@@ -1,47 +1,57 @@
 /**
  * @file BST.h
  * @author Svetlana Alkhasova
- * @date 18/07/25
- * @version 2.0
- * @brief Templated BST Binary Search Tree with full set of operations (insert, search, traversal, copy).
- * minimal and completed BST template class
+ * @date 16/10/26
+ * @version 3.2
+ * @brief Templated balanced (AVL) Binary Search Tree with iterators, range queries and traversals.
+ *
+ * Nodes live in one pooled Vector and link to each other by position, so the
+ * tree is a single allocation that copies and moves like a Vector. Every
+ * operation is iterative: nothing recurses, whatever the size of the tree.
  */
 
 #ifndef BST_H
 #define BST_H
 
-#include <iostream>
-#include <stdexcept>
+#include "Vector.h"
+#include <utility>
 
  /**
  * @struct Node
  * @brief Node structure for BST
  *
  * This structure represents each node in a templated binary search tree.
- * It stores the data and pointers to the left and right child.
+ * It stores the data, the positions of its children and parent in the
+ * tree's node pool (-1 for none) and the height of its subtree.
  *
  * @tparam T Data type stored in each node. Must support comparison operators.
  */
 template <typename T>
 struct Node {
     T data;     ///< Value stored in this node
-    Node* left; ///< Pointer to left child
-    Node* right;///< Pointer to right child
+    int left;   ///< Position of left child (-1 if none)
+    int right;  ///< Position of right child (-1 if none)
+    int parent; ///< Position of parent (-1 for the root)
+    int height; ///< Height of the subtree rooted here (1 for a leaf)
 };
 
 /**
 * @class BST
-* @brief Templated Binary Search Tree (BST) implementation.
+* @brief Templated self-balancing Binary Search Tree (AVL tree).
+*
+* Provides insertion, removal, searching, sorted iteration, lower/upper bound range
+* queries and three types of traversal. Visitors can be function pointers,
+* functors or lambdas (capturing state is fine).
 *
-* Provides methods for insertion, searching, copying, and
-* three types of traversal using function pointers.
+* Heights of the two subtrees of any node differ by at most one, so keys
+* inserted in sorted order (as chronological data files give) still make a
+* tree of depth O(log n). A range of k values is visited in O(log n + k).
 *
-* The tree stores values of type T which must implement comparison operators.
-* All resources are properly managed for deep copy and destruction.
+* The tree stores values of type T which must implement operator<.
 *
 * @author Svetlana Alkhasova
-* @version 2.0
-* @date 18/07/25
+* @version 3.0
+* @date 16/10/26
 *
 * @tparam T Data type stored in BST nodes (must support comparison)
 */
@@ -49,42 +59,108 @@ template <typename T>
 class BST {
 public:
     /**
-     * @brief Default constructor.
+     * @class const_iterator
+     * @brief Walks the values in increasing order.
      *
-     * Initializes an empty BST.
+     * Stays valid while no value is inserted.
      */
-    BST();
+    class const_iterator {
+    public:
+        /**
+         * @brief Value the iterator is at.
+         * @return Reference to the value.
+         */
+        const T& operator*() const { return tree->node(at).data; }
+
+        /**
+         * @brief Member access to the value the iterator is at.
+         * @return Pointer to the value.
+         */
+        const T* operator->() const { return &tree->node(at).data; }
+
+        /**
+         * @brief Moves to the next larger value.
+         * @return Reference to this iterator.
+         */
+        const_iterator& operator++() { at = tree->successor(at); return *this; }
+
+        /**
+         * @brief Compares positions.
+         * @param other Iterator of the same tree.
+         * @return True if both are at the same node (or both at the end).
+         */
+        bool operator==(const const_iterator& other) const { return at == other.at; }
+
+        /**
+         * @brief Compares positions.
+         * @param other Iterator of the same tree.
+         * @return True if they are at different nodes.
+         */
+        bool operator!=(const const_iterator& other) const { return at != other.at; }
+
+    private:
+        friend class BST;
+        const_iterator(const BST* tree, int at) : tree(tree), at(at) {}
+
+        const BST* tree; ///< Tree being walked
+        int at;          ///< Current node position (-1 at the end)
+    };
 
     /**
-     * @brief Destructor
+     * @brief Default constructor.
      *
-     * Frees all nodes and memory used by BST.
+     * Initializes an empty BST.
      */
-    ~BST();
+    BST();
 
     /**
      * @brief Copy constructor for deep copy.
      * @param other Another BST of the same type
-     *
-     * Creates a new BST as a deep copy of another tree.
      */
     BST(const BST<T>& other);
 
     /**
-     * @brief Assignment operator (deep copy/cleanup)
+     * @brief Move constructor, takes over the other tree's nodes.
+     * @param other BST to move from (left empty).
+     */
+    BST(BST<T>&& other) noexcept;
+
+    /**
+     * @brief Assignment operator (deep copy)
      * @param otherTree BST to assign from.
      * @return Reference to this BST after assignment.
      */
     BST<T>& operator=(const BST<T>& otherTree);
 
+    /**
+     * @brief Move assignment, takes over the other tree's nodes.
+     * @param otherTree BST to move from (left empty).
+     * @return Reference to this BST after assignment.
+     */
+    BST<T>& operator=(BST<T>&& otherTree) noexcept;
+
     /**
      * @brief Insert value into BST.
      *
-     * Adds a new value to the tree. If the value already exists, it is not inserted again.
+     * Adds a new value to the tree and rebalances it. If the value already
+     * exists, it is not inserted again.
      *
      * @param value Value to be inserted.
+     * @return True if the value was added, false if it was already there.
      */
-    void insert(const T& value);
+    bool insert(const T& value);
+
+    /**
+     * @brief Remove a value from the BST.
+     *
+     * Takes the value out and rebalances the tree. The last node of the pool
+     * moves into the freed position, so the pool stays packed; iterators
+     * are not valid afterwards.
+     *
+     * @param value Value to be removed.
+     * @return True if the value was removed, false if it was not there.
+     */
+    bool remove(const T& value);
 
     /**
      * @brief Search for a value in the BST.
@@ -94,204 +170,471 @@ public:
      */
     bool search(const T& value) const;
 
+    /**
+     * @brief Number of values in the tree.
+     * @return The count of values.
+     */
+    int GetSize() const;
+
+    /**
+     * @brief Removes every value.
+     */
+    void Clear();
+
+    /**
+     * @brief Iterator at the smallest value.
+     * @return Start of the sorted values (equal to end() if empty).
+     */
+    const_iterator begin() const;
+
+    /**
+     * @brief Iterator past the largest value.
+     * @return End of the sorted values.
+     */
+    const_iterator end() const;
+
+    /**
+     * @brief Iterator at the largest value.
+     * @return Position of the largest value (equal to end() if empty).
+     */
+    const_iterator last() const;
+
+    /**
+     * @brief First value that is not less than a given one.
+     * @param value Value to compare with.
+     * @return Iterator at that value, end() if every value is less.
+     */
+    const_iterator lowerBound(const T& value) const;
+
+    /**
+     * @brief First value that is greater than a given one.
+     * @param value Value to compare with.
+     * @return Iterator at that value, end() if no value is greater.
+     */
+    const_iterator upperBound(const T& value) const;
+
+    /**
+     * @brief Calls process for every value from low to high (both included), in sorted order.
+     *
+     * Example: every month key of 2015 to 2017 is
+     * forEachInRange(monthKey(2015, 1), monthKey(2017, 12), visit).
+     *
+     * @param low Smallest value of the range.
+     * @param high Largest value of the range.
+     * @param process Function, functor or lambda taking const T&.
+     */
+    template <typename Visit>
+    void forEachInRange(const T& low, const T& high, Visit process) const;
+
     /**
      * @brief In-order traversal (left, root, right).
      *
-     * Calls the given function pointer for each node in sorted order.
+     * Calls process for each node in sorted order.
      *
-     * @param process Function pointer to process each node's data.
+     * @param process Function, functor or lambda taking const T&.
      */
-    void InOrder(void (*process)(const T&)) const;
+    template <typename Visit>
+    void InOrder(Visit process) const;
 
     /**
      * @brief Pre-order traversal (root, left, right).
      *
-     * Calls the given function pointer for each node in pre-order.
+     * Calls process for each node in pre-order.
      *
-     * @param process Function pointer to process each node's data.
+     * @param process Function, functor or lambda taking const T&.
      */
-    void PreOrder(void (*process)(const T&)) const;
+    template <typename Visit>
+    void PreOrder(Visit process) const;
 
     /**
      * @brief Post-order traversal (left, right, root).
      *
-     * Calls the given function pointer for each node in post-order.
+     * Calls process for each node in post-order.
      *
-     * @param process Function pointer to process each node's data.
+     * @param process Function, functor or lambda taking const T&.
      */
-    void PostOrder(void (*process)(const T&)) const;
+    template <typename Visit>
+    void PostOrder(Visit process) const;
 
 private:
-    Node<T>* root; ///< Root pointer
+    Vector<Node<T> > nodes; ///< Node pool, in insertion order
+    int root;               ///< Position of the root (-1 if empty)
 
     /**
-     * @brief Helper to deep copy a subtree.
-     *
-     * @param node Subtree to copy.
-     * @return Pointer to new subtree.
+     * @brief Node at a pool position (unchecked).
+     * @param at Position in the pool.
+     * @return Reference to the node.
      */
-    Node<T>* copy(Node<T>* node);
+    Node<T>& node(int at) { return nodes.GetData()[at]; }
 
     /**
-     * @brief Helper for recursive destruction.
-     * @param node Subtree to destroy.
+     * @brief Same as above, for read-only access.
      */
-    void destroy(Node<T>* node);
+    const Node<T>& node(int at) const { return nodes.GetData()[at]; }
 
     /**
-     * @brief Helper for recursive node insertion.
-     * @param node Subtree to insert into.
-     * @param value Value to insert.
-     * @return Updated subtree pointer.
+     * @brief Height of a subtree.
+     * @param at Position of its root (-1 for an empty subtree).
+     * @return The height, 0 for an empty subtree.
      */
-    Node<T>* insert(Node<T>* node, const T& value);
+    int height(int at) const;
 
     /**
-     * @brief Helper for recursive search in subtree.
-     * @param node Subtree to search.
-     * @param value Value to search for.
-     * @return True if value is found, else false.
+     * @brief Recomputes a node's height from its children.
+     * @param at Position of the node.
+     */
+    void updateHeight(int at);
+
+    /**
+     * @brief Makes the parent of a node point to a replacement instead.
+     * @param parent Position of the parent (-1 if the node was the root).
+     * @param from Position of the node being replaced.
+     * @param to Position of the replacement.
+     */
+    void replaceChild(int parent, int from, int to);
+
+    /**
+     * @brief Rotates a subtree left (its right child becomes its root).
+     * @param at Position of the subtree root.
+     * @return Position of the new subtree root.
+     */
+    int rotateLeft(int at);
+
+    /**
+     * @brief Rotates a subtree right (its left child becomes its root).
+     * @param at Position of the subtree root.
+     * @return Position of the new subtree root.
+     */
+    int rotateRight(int at);
+
+    /**
+     * @brief Restores the balance of every node from one node up to the root.
+     * @param at Position of the lowest node whose subtree grew or shrank (-1 for none).
      */
-    bool search(Node<T>* node, const T& value) const;
+    void rebalance(int at);
 
     /**
-     * @brief Helper for in-order traversal in subtree.
-     * @param node Subtree to process.
-     * @param process Function pointer for processing node data.
+     * @brief Leftmost node of a subtree.
+     * @param at Position of the subtree root.
+     * @return Position of the smallest value in it.
      */
-    void InOrder(Node<T>* node, void (*process)(const T&)) const;
+    int leftmost(int at) const;
 
     /**
-     * @brief Helper for pre-order traversal in subtree.
-     * @param node Subtree to process.
-     * @param process Function pointer for processing node data.
+     * @brief Rightmost node of a subtree.
+     * @param at Position of the subtree root.
+     * @return Position of the largest value in it.
      */
-    void PreOrder(Node<T>* node, void (*process)(const T&)) const;
+    int rightmost(int at) const;
 
     /**
-     * @brief Helper for post-order traversal in subtree.
-     * @param node Subtree to process.
-     * @param process Function pointer for processing node data.
+     * @brief Next node in sorted order.
+     * @param at Position of a node.
+     * @return Position of the next larger value (-1 if at is the largest).
      */
-    void PostOrder(Node<T>* node, void (*process)(const T&)) const;
+    int successor(int at) const;
 };
 
 // IMPLEMENTATION
 
 template <typename T>
-BST<T>::BST() : root(NULL) {}
+BST<T>::BST() : root(-1) {}
 
 template <typename T>
-BST<T>::~BST() {
-    destroy(root);
-    root = NULL;
-}
+BST<T>::BST(const BST<T>& other) : nodes(other.nodes), root(other.root) {}
 
 template <typename T>
-BST<T>::BST(const BST<T>& other) {
-    root = copy(other.root);
+BST<T>::BST(BST<T>&& other) noexcept : nodes(std::move(other.nodes)), root(other.root) {
+    other.root = -1;
 }
 
 template <typename T>
 BST<T>& BST<T>::operator=(const BST<T>& otherTree) {
     if (this != &otherTree) {
-        destroy(root);
-        root = copy(otherTree.root);
+        nodes = otherTree.nodes;
+        root = otherTree.root;
     }
     return *this;
 }
 
 template <typename T>
-Node<T>* BST<T>::copy(Node<T>* node) {
-    if (!node) return NULL;
-    Node<T>* newNode = new Node<T>;
-    newNode->data = node->data;
-    newNode->left = copy(node->left);
-    newNode->right = copy(node->right);
-    return newNode;
+BST<T>& BST<T>::operator=(BST<T>&& otherTree) noexcept {
+    if (this != &otherTree) {
+        nodes = std::move(otherTree.nodes);
+        root = otherTree.root;
+        otherTree.root = -1;
+    }
+    return *this;
 }
 
 template <typename T>
-void BST<T>::insert(const T& value) {
-    root = insert(root, value);
+bool BST<T>::insert(const T& value) {
+    //find the empty spot, stop if the value is already there
+    int parent = -1;
+    bool goLeft = false;
+    for (int at = root; at != -1; ) {
+        parent = at;
+        if (value < node(at).data) { goLeft = true; at = node(at).left; }
+        else if (node(at).data < value) { goLeft = false; at = node(at).right; }
+        else return false;
+    }
+
+    Node<T> added;
+    added.data = value;
+    added.left = -1;
+    added.right = -1;
+    added.parent = parent;
+    added.height = 1;
+    nodes.pushBack(std::move(added));
+    int at = nodes.GetSize() - 1;
+
+    if (parent == -1) root = at;
+    else if (goLeft) node(parent).left = at;
+    else node(parent).right = at;
+    rebalance(parent);
+    return true;
 }
 
 template <typename T>
-Node<T>* BST<T>::insert(Node<T>* node, const T& value) {
-    if (!node) {
-        Node<T>* newNode = new Node<T>;
-        newNode->data = value;
-        newNode->left = NULL;
-        newNode->right = NULL;
-        return newNode;
+bool BST<T>::remove(const T& value) {
+    int at = root;
+    while (at != -1) {
+        if (value < node(at).data) at = node(at).left;
+        else if (node(at).data < value) at = node(at).right;
+        else break;
+    }
+    if (at == -1) return false;
+
+    //a node with two children takes its successor's value, and the successor's node goes instead
+    if (node(at).left != -1 && node(at).right != -1) {
+        int next = leftmost(node(at).right);
+        node(at).data = std::move(node(next).data);
+        at = next;
     }
-    if (value < node->data)
-        node->left = insert(node->left, value);
-    else if (value > node->data)
-        node->right = insert(node->right, value);
-    return node;
+    //the node has one child at most now, which takes its place
+    int child = node(at).left != -1 ? node(at).left : node(at).right;
+    int parent = node(at).parent;
+    if (child != -1) node(child).parent = parent;
+    replaceChild(parent, at, child);
+    rebalance(parent);
+
+    //the last node of the pool fills the hole
+    int last = nodes.GetSize() - 1;
+    if (at != last) {
+        node(at) = std::move(node(last));
+        if (node(at).left != -1) node(node(at).left).parent = at;
+        if (node(at).right != -1) node(node(at).right).parent = at;
+        replaceChild(node(at).parent, last, at);
+    }
+    nodes.popBack();
+    return true;
 }
 
 template <typename T>
 bool BST<T>::search(const T& value) const {
-    return search(root, value);
+    for (int at = root; at != -1; ) {
+        if (value < node(at).data) at = node(at).left;
+        else if (node(at).data < value) at = node(at).right;
+        else return true;
+    }
+    return false;
 }
 
 template <typename T>
-bool BST<T>::search(Node<T>* node, const T& value) const {
-    if (!node) return false;
-    if (node->data == value) return true;
-    if (value < node->data)
-        return search(node->left, value);
-    return search(node->right, value);
+int BST<T>::GetSize() const {
+    return nodes.GetSize();
 }
 
 template <typename T>
-void BST<T>::InOrder(void (*process)(const T&)) const {
-    InOrder(root, process);
+void BST<T>::Clear() {
+    nodes.Clear();
+    root = -1;
 }
 
 template <typename T>
-void BST<T>::InOrder(Node<T>* node, void (*process)(const T&)) const {
-    if (!node) return;
-    InOrder(node->left, process);
-    process(node->data);
-    InOrder(node->right, process);
+typename BST<T>::const_iterator BST<T>::begin() const {
+    return const_iterator(this, root == -1 ? -1 : leftmost(root));
 }
 
 template <typename T>
-void BST<T>::PreOrder(void (*process)(const T&)) const {
-    PreOrder(root, process);
+typename BST<T>::const_iterator BST<T>::end() const {
+    return const_iterator(this, -1);
 }
 
 template <typename T>
-void BST<T>::PreOrder(Node<T>* node, void (*process)(const T&)) const {
-    if (!node) return;
-    process(node->data);
-    PreOrder(node->left, process);
-    PreOrder(node->right, process);
+typename BST<T>::const_iterator BST<T>::last() const {
+    return const_iterator(this, root == -1 ? -1 : rightmost(root));
 }
 
 template <typename T>
-void BST<T>::PostOrder(void (*process)(const T&)) const {
-    PostOrder(root, process);
+typename BST<T>::const_iterator BST<T>::lowerBound(const T& value) const {
+    int found = -1;
+    for (int at = root; at != -1; ) {
+        if (node(at).data < value) at = node(at).right;
+        else { found = at; at = node(at).left; }
+    }
+    return const_iterator(this, found);
 }
 
 template <typename T>
-void BST<T>::PostOrder(Node<T>* node, void (*process)(const T&)) const {
-    if (!node) return;
-    PostOrder(node->left, process);
-    PostOrder(node->right, process);
-    process(node->data);
+typename BST<T>::const_iterator BST<T>::upperBound(const T& value) const {
+    int found = -1;
+    for (int at = root; at != -1; ) {
+        if (value < node(at).data) { found = at; at = node(at).left; }
+        else at = node(at).right;
+    }
+    return const_iterator(this, found);
+}
+
+template <typename T>
+template <typename Visit>
+void BST<T>::forEachInRange(const T& low, const T& high, Visit process) const {
+    for (const_iterator it = lowerBound(low); it != end() && !(high < *it); ++it)
+        process(*it);
+}
+
+template <typename T>
+template <typename Visit>
+void BST<T>::InOrder(Visit process) const {
+    for (const_iterator it = begin(); it != end(); ++it)
+        process(*it);
 }
 
 template <typename T>
-void BST<T>::destroy(Node<T>* node) {
-    if (!node) return;
-    destroy(node->left);
-    destroy(node->right);
-    delete node;
-    node = NULL;
+template <typename Visit>
+void BST<T>::PreOrder(Visit process) const {
+    int at = root;
+    while (at != -1) {
+        process(node(at).data);
+        if (node(at).left != -1) { at = node(at).left; continue; }
+        if (node(at).right != -1) { at = node(at).right; continue; }
+        //climb until a parent has a right subtree not visited yet
+        int parent = node(at).parent;
+        while (parent != -1 && (node(parent).right == at || node(parent).right == -1)) {
+            at = parent;
+            parent = node(at).parent;
+        }
+        at = parent == -1 ? -1 : node(parent).right;
+    }
+}
+
+template <typename T>
+template <typename Visit>
+void BST<T>::PostOrder(Visit process) const {
+    if (root == -1) return;
+    //first node in post-order: go down, left whenever possible
+    int at = root;
+    for (;;) {
+        if (node(at).left != -1) at = node(at).left;
+        else if (node(at).right != -1) at = node(at).right;
+        else break;
+    }
+    while (at != -1) {
+        process(node(at).data);
+        int parent = node(at).parent;
+        if (parent != -1 && node(parent).left == at && node(parent).right != -1) {
+            //the parent's right subtree comes next
+            at = node(parent).right;
+            for (;;) {
+                if (node(at).left != -1) at = node(at).left;
+                else if (node(at).right != -1) at = node(at).right;
+                else break;
+            }
+        } else {
+            at = parent;
+        }
+    }
+}
+
+template <typename T>
+int BST<T>::height(int at) const {
+    return at == -1 ? 0 : node(at).height;
+}
+
+template <typename T>
+void BST<T>::updateHeight(int at) {
+    int hl = height(node(at).left);
+    int hr = height(node(at).right);
+    node(at).height = (hl > hr ? hl : hr) + 1;
+}
+
+template <typename T>
+void BST<T>::replaceChild(int parent, int from, int to) {
+    if (parent == -1) root = to;
+    else if (node(parent).left == from) node(parent).left = to;
+    else node(parent).right = to;
+}
+
+template <typename T>
+int BST<T>::rotateLeft(int at) {
+    int up = node(at).right;
+    node(at).right = node(up).left;
+    if (node(up).left != -1) node(node(up).left).parent = at;
+    node(up).parent = node(at).parent;
+    replaceChild(node(at).parent, at, up);
+    node(up).left = at;
+    node(at).parent = up;
+    updateHeight(at);
+    updateHeight(up);
+    return up;
+}
+
+template <typename T>
+int BST<T>::rotateRight(int at) {
+    int up = node(at).left;
+    node(at).left = node(up).right;
+    if (node(up).right != -1) node(node(up).right).parent = at;
+    node(up).parent = node(at).parent;
+    replaceChild(node(at).parent, at, up);
+    node(up).right = at;
+    node(at).parent = up;
+    updateHeight(at);
+    updateHeight(up);
+    return up;
+}
+
+template <typename T>
+void BST<T>::rebalance(int at) {
+    while (at != -1) {
+        int before = node(at).height;
+        updateHeight(at);
+        int balance = height(node(at).left) - height(node(at).right);
+        if (balance > 1) {
+            int child = node(at).left;
+            if (height(node(child).left) < height(node(child).right)) rotateLeft(child);
+            at = rotateRight(at);
+        } else if (balance < -1) {
+            int child = node(at).right;
+            if (height(node(child).right) < height(node(child).left)) rotateRight(child);
+            at = rotateLeft(at);
+        }
+        //a rotation or an unchanged height settles the rest of the path
+        if (node(at).height == before) break;
+        at = node(at).parent;
+    }
+}
+
+template <typename T>
+int BST<T>::leftmost(int at) const {
+    while (node(at).left != -1) at = node(at).left;
+    return at;
+}
+
+template <typename T>
+int BST<T>::rightmost(int at) const {
+    while (node(at).right != -1) at = node(at).right;
+    return at;
+}
+
+template <typename T>
+int BST<T>::successor(int at) const {
+    if (node(at).right != -1) return leftmost(node(at).right);
+    int parent = node(at).parent;
+    while (parent != -1 && node(parent).right == at) {
+        at = parent;
+        parent = node(at).parent;
+    }
+    return parent;
 }
 
 #endif // BST_H
@@ -0,0 +1,143 @@
+/**
+ * @file BatchRunner.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Runs scripted queries against the loaded data without the interactive menu.
+ *
+ * One query per line, the same questions the menu answers:
+ *   - wind YEAR MONTH   average and std dev of the wind speed (menu option 1)
+ *   - temp YEAR         average and std dev of the temperature per month (option 2)
+ *   - corr MONTH        S_T, S_R and T_R of that month in the earliest year with it (option 3)
+ *   - report YEAR       the WindTempSolar.csv values of every month (option 4)
+ *   - range dd/mm/yyyy hh:mm dd/mm/yyyy hh:mm   statistics of a time window (option 5)
+ *
+ * Blank lines and lines starting with # are skipped. Results are written as
+ * tab separated rows "id, query, year, month, field, value" under a header
+ * line, with the values at full float precision, so scripts can read them
+ * without parsing the menu's sentences.
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "LazyLoader.h"
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "WeatherLog.h"
+#include "MonthTable.h"
+#include "Vector.h"
+#include <iostream>
+#include <string>
+
+/**
+* @enum QueryKind
+* @brief What a batch query asks for.
+**/
+enum QueryKind {
+    QUERY_WIND,        ///< wind YEAR MONTH
+    QUERY_TEMP,        ///< temp YEAR
+    QUERY_CORRELATION, ///< corr MONTH
+    QUERY_REPORT,      ///< report YEAR
+    QUERY_RANGE        ///< range FROM TO
+};
+
+/**
+* @struct BatchQuery
+* @brief One parsed query line.
+**/
+struct BatchQuery {
+    QueryKind kind; ///< What is asked for
+    int year;       ///< Year (wind, temp, report)
+    int month;      ///< Month 1-12 (wind, corr)
+    int from;       ///< Start of the window in epoch minutes (range)
+    int to;         ///< End of the window in epoch minutes, included (range)
+
+    /**
+    * @brief Creates a wind query for no month.
+    */
+    BatchQuery() : kind(QUERY_WIND), year(0), month(0), from(0), to(0) {}
+};
+
+    /**
+     * @class BatchRunner
+     * @brief Static utility class that parses, runs and prints batch queries.
+     *
+     * Months the queries need are loaded first, one query after the other on
+     * the calling thread (a LazyLoader is not thread safe). After that the
+     * data is only read, so the queries run in parallel, each into its own
+     * buffer, and the buffers are printed in script order.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class BatchRunner {
+public:
+        /**
+         * @brief Parses one query line.
+         * @param line The query text.
+         * @param query Receives the query.
+         * @param error Receives why the line is not a valid query.
+         * @return False if the line is not a valid query.
+         */
+    static bool parseQuery(const std::string& line, BatchQuery& query, std::string& error);
+
+        /**
+         * @brief Reads the query lines of a script, skipping blank lines and # comments.
+         * @param filename Path of the script, "-" reads standard input.
+         * @param lines Receives the query lines.
+         * @return False if the script can not be opened.
+         */
+    static bool readScript(const std::string& filename, Vector<std::string>& lines);
+
+        /**
+         * @brief Runs every query and prints the results in query order.
+         *
+         * A line that does not parse gives an "error" row and does not stop
+         * the others. The query count, time and rate are printed to std::cerr.
+         *
+         * @param lines Query lines (see readScript).
+         * @param dataMap Table of WeatherLogs by month key.
+         * @param index Per-month sums.
+         * @param ranges Time-sorted running sums.
+         * @param lazy Loader for the months the queries need (one that is not open does nothing).
+         * @param threads Worker threads, 0 means one per core.
+         * @param out Stream the result rows are written to.
+         * @return Number of lines that were not valid queries.
+         */
+    static int run(const Vector<std::string>& lines, const MonthTable<WeatherLog>& dataMap,
+                   const MonthIndex& index, const RangeIndex& ranges, LazyLoader& lazy, int threads,
+                   std::ostream& out);
+
+        /**
+         * @brief Loads the months a query reads (call before running queries in parallel).
+         * @param query The query.
+         * @param lazy Loader to fill the structures with.
+         */
+    static void prepare(const BatchQuery& query, LazyLoader& lazy);
+
+        /**
+         * @brief Answers one query into a string of result rows.
+         *
+         * Only reads the structures, so several queries can run at once.
+         *
+         * @param query The query.
+         * @param id Number of the query, first column of every row.
+         * @param dataMap Table of WeatherLogs by month key.
+         * @param index Per-month sums.
+         * @param ranges Time-sorted running sums.
+         * @param result Receives the rows.
+         */
+    static void runQuery(const BatchQuery& query, int id, const MonthTable<WeatherLog>& dataMap,
+                         const MonthIndex& index, const RangeIndex& ranges, std::string& result);
+
+        /**
+         * @brief Name of a query kind as written in scripts.
+         * @param kind The kind.
+         * @return "wind", "temp", "corr", "report" or "range".
+         */
+    static const char* kindName(QueryKind kind);
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,68 @@
+/**
+ * @file ColumnView.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Read-only, non-owning view of a contiguous column of values.
+ */
+
+#ifndef COLUMNVIEW_H
+#define COLUMNVIEW_H
+
+#include <stdexcept>
+
+    /**
+     * @class ColumnView
+     * @brief Pointer and length over values stored somewhere else (like a WeatherLog column).
+     *
+     * Copying a view never copies the values. A view is only valid while the
+     * storage it points into is alive and not changed in size.
+     * It has GetSize() and operator[] like Vector, so the Statistics functions
+     * work on both.
+     *
+     * @tparam T Type of the values in the column.
+     */
+template <typename T>
+class ColumnView {
+public:
+        /**
+         * @brief Creates an empty view.
+         */
+    ColumnView() : data(NULL), size(0) {}
+
+        /**
+         * @brief Creates a view over size values starting at data.
+         * @param data First value (may be NULL when size is 0).
+         * @param size Number of values.
+         */
+    ColumnView(const T* data, int size) : data(data), size(size) {}
+
+        /**
+         * @brief Number of values in the view.
+         * @return The count of elements.
+         */
+    int GetSize() const { return size; }
+
+        /**
+         * @brief Pointer to the first value, for loops that don't need range checks.
+         * @return Start of the values (NULL if empty).
+         */
+    const T* GetData() const { return data; }
+
+        /**
+         * @brief Read access by index.
+         * @param index Which element to access (starts at 0)
+         * @return Reference to the requested element.
+         * @throws std::out_of_range if index is wrong.
+         */
+    const T& operator[](int index) const {
+        if (index < 0 || index >= size) throw std::out_of_range("Index out of range");
+        return data[index];
+    }
+
+private:
+    const T* data; ///< First value of the column
+    int size;      ///< Number of values
+};
+
+#endif // COLUMNVIEW_H
@@ -0,0 +1,171 @@
+/**
+ * @file CompressedReader.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Streams the decompressed text of a .gz or .zst file from a background thread.
+ *
+ * Archived station data is kept compressed. Instead of unpacking it to disk
+ * first, a CompressedReader decompresses on its own thread into a small
+ * ring of fixed size blocks, and the loader parses each block while the
+ * next ones are being decompressed. When the ring is full the decompressor
+ * waits for the parser, so memory use stays at a few blocks whatever the
+ * file size.
+ *
+ * Support is chosen when compiling: define WEATHER_ZLIB (link with -lz) for
+ * gzip and WEATHER_ZSTD (link with -lzstd) for zstd. Without them such
+ * files are reported as not supported by this build.
+ */
+
+#ifndef COMPRESSEDREADER_H
+#define COMPRESSEDREADER_H
+
+#include "MappedFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+* @enum Compression
+* @brief Compression format of a data file, from its name.
+**/
+enum Compression {
+    COMPRESSION_NONE, ///< Plain CSV
+    COMPRESSION_GZIP, ///< Ends in .gz
+    COMPRESSION_ZSTD  ///< Ends in .zst
+};
+
+/**
+* @brief Works out the compression of a file from its suffix.
+* @param filename File name or path.
+* @return The format, COMPRESSION_NONE for anything but .gz and .zst.
+*/
+Compression compressionOf(const std::string& filename);
+
+    /**
+     * @class CompressedReader
+     * @brief Decompresses one file on a worker thread and hands the text out in blocks.
+     *
+     * Blocks come out in file order and together hold exactly the
+     * decompressed bytes; a block can end anywhere, also in the middle of
+     * a line. Gzip files made of several members (like concatenated .gz
+     * files) are read through to the end.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class CompressedReader {
+public:
+    static const std::size_t BLOCK_BYTES = 1 << 20; ///< Decompressed bytes per block (the last one can be shorter)
+    static const int QUEUE_BLOCKS = 4;              ///< Blocks that can wait for the parser
+
+        /**
+         * @brief Creates a reader with no file.
+         */
+    CompressedReader();
+
+        /**
+         * @brief Stops the worker thread if it is still running.
+         */
+    ~CompressedReader();
+
+        /**
+         * @brief Opens a compressed file and starts decompressing it.
+         * @param filename Path to a .gz or .zst file.
+         * @return False if the file can not be opened or its format is not
+         *         supported by this build (see GetError()).
+         */
+    bool open(const std::string& filename);
+
+        /**
+         * @brief Takes the next block of text, waiting for it if needed.
+         *
+         * The block is swapped into the string, so the storage of the string
+         * passed in is used again for later blocks.
+         *
+         * @param block Receives the text.
+         * @return False at the end of the data or after an error (see Failed()).
+         */
+    bool read(std::string& block);
+
+        /**
+         * @brief Stops the worker thread and releases the file.
+         */
+    void close();
+
+        /**
+         * @brief Tells whether the data was damaged or cut short.
+         *
+         * Only final once read() has returned false.
+         *
+         * @return True if decompression failed.
+         */
+    bool Failed() const;
+
+        /**
+         * @brief Message for the last failure, to be followed by the file name.
+         * @return The message, empty if nothing failed.
+         */
+    const std::string& GetError() const;
+
+        /**
+         * @brief Decompresses a whole file into memory.
+         * @param filename Path to a .gz or .zst file.
+         * @param text Receives the decompressed bytes.
+         * @param error Receives the message and file name on failure.
+         * @return False if the file could not be read in full.
+         */
+    static bool readAll(const std::string& filename, std::string& text, std::string& error);
+
+private:
+    CompressedReader(const CompressedReader&);
+    CompressedReader& operator=(const CompressedReader&);
+
+        /**
+         * @brief Worker thread body: decompresses the whole file into the ring.
+         */
+    void run();
+
+        /**
+         * @brief Hands a filled block to the ring, waiting while it is full.
+         * @param block The block, swapped for an empty one to fill next.
+         * @return False if the reader is being closed.
+         */
+    bool push(std::string& block);
+
+        /**
+         * @brief Ends the stream, from the worker thread.
+         * @param message Error message, empty for a normal end.
+         */
+    void finish(const std::string& message);
+
+        /**
+         * @brief Decompresses a gzip input into the ring.
+         * @return False if the data is damaged or cut short (error is set).
+         */
+    bool inflateGzip();
+
+        /**
+         * @brief Decompresses a zstd input into the ring.
+         * @return False if the data is damaged or cut short (error is set).
+         */
+    bool decompressZstd();
+
+    MappedFile input;                  ///< The compressed bytes
+    Compression format;                ///< Format of input
+    std::thread worker;                ///< Decompressing thread
+    std::mutex lock;                   ///< Guards everything below
+    std::condition_variable notFull;   ///< Signalled when the parser takes a block
+    std::condition_variable notEmpty;  ///< Signalled when a block is added or the stream ends
+    std::string slots[QUEUE_BLOCKS];   ///< Ring of decompressed blocks
+    int head;                          ///< Next block to read
+    int count;                         ///< Blocks waiting
+    bool done;                         ///< The worker has added its last block
+    bool stopping;                     ///< close() wants the worker to stop
+    std::string error;                 ///< Failure message
+};
+
+#endif // COMPRESSEDREADER_H
@@ -0,0 +1,58 @@
+/**
+ * @file CsvFields.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief In-place CSV field slices, for splitting a whole line into its cells.
+ *
+ * A field is kept as a pointer and length into the file buffer instead of
+ * being copied into its own std::string. The loader itself does not split
+ * lines; it decodes only the columns it needs with a ParsePlan.
+ */
+
+#ifndef CSVFIELDS_H
+#define CSVFIELDS_H
+
+#include "Vector.h"
+
+/**
+* @struct FieldSlice
+* @brief One CSV cell as a pointer/length pair into a buffer (not null terminated).
+**/
+struct FieldSlice {
+    const char* begin; ///< First character of the cell
+    int length;        ///< Number of characters in the cell
+
+    /** @brief One past the last character of the cell. */
+    const char* end() const { return begin + length; }
+};
+
+    /**
+     * @brief Splits one line into field slices.
+     *
+     * Follows the same rules as reading the line with std::getline(ss, cell, ','):
+     * an empty line has no fields and an empty cell after a trailing comma is dropped.
+     * The fields vector is cleared first but keeps its capacity, so reusing it
+     * between rows does not allocate.
+     *
+     * @param begin First character of the line.
+     * @param end One past the last character (newline not included).
+     * @param fields Receives the slices.
+     */
+inline void splitFields(const char* begin, const char* end, Vector<FieldSlice>& fields) {
+    fields.Clear();
+    const char* cell = begin;
+    for (const char* p = begin; p != end; ++p) {
+        if (*p == ',') {
+            FieldSlice f = {cell, static_cast<int>(p - cell)};
+            fields.pushBack(f);
+            cell = p + 1;
+        }
+    }
+    if (cell != end) {
+        FieldSlice f = {cell, static_cast<int>(end - cell)};
+        fields.pushBack(f);
+    }
+}
+
+#endif // CSVFIELDS_H
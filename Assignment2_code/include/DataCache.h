@@ -0,0 +1,105 @@
+/**
+ * @file DataCache.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.2
+ * @brief Binary snapshot of the loaded weather data, so later runs can skip CSV parsing.
+ *
+ * The cache holds one section per source file. A section is only reused when the
+ * file's size, modification time and content hash still match, otherwise that
+ * file is parsed again with FileHandler::parseCSV.
+ *
+ * File layout (native byte order, all counts are 32 bit):
+ *   - header: magic "WSC1", byte order mark 0x01020304, format version, loaded
+ *     fields (a FieldSet, see MetFields.h), number of sections
+ *   - per section: name length + name, file size (int64), mtime (int64), hash (uint64),
+ *     number of months
+ *   - per month: year, month, row count, then the columns one after another:
+ *     time[n] (int32 epoch minutes), wind[n], temperature[n], solar[n] (float),
+ *     then one float[n] per extra field in MetField order
+ *
+ * A cache written for a different set of fields is not used.
+ */
+
+#ifndef DATACACHE_H
+#define DATACACHE_H
+
+#include "FileHandler.h"
+#include "Vector.h"
+#include <string>
+
+/**
+* @struct SourceStamp
+* @brief Identifies the exact contents of one data file.
+**/
+struct SourceStamp {
+    std::string name;        ///< File name as listed in data_source.txt
+    long long size;          ///< File size in bytes
+    long long mtime;         ///< Last modification time (seconds since epoch)
+    unsigned long long hash; ///< 64-bit FNV-1a hash of the contents
+    bool valid;              ///< False if the file could not be read
+    bool endsLine;           ///< The contents end with a newline (or are empty), not stored in the cache
+
+    /**
+    * @brief Creates an invalid stamp.
+    */
+    SourceStamp() : size(0), mtime(0), hash(0), valid(false), endsLine(false) {}
+};
+
+    /**
+     * @class DataCache
+     * @brief Static helpers to write and restore the binary data cache.
+     *
+     * This class is not intended to be instantiated.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class DataCache {
+public:
+        /**
+         * @brief Current cache format version, older or newer files are ignored.
+         */
+    static const unsigned FORMAT_VERSION = 3;
+
+        /**
+         * @brief Reads size, modification time and content hash of a file.
+         * @param path Path used to open the file.
+         * @param name Name stored in the stamp (as listed in data_source.txt).
+         * @param stamp Receives the result, stamp.valid is false if the file can't be read.
+         */
+    static void stampFile(const std::string& path, const std::string& name, SourceStamp& stamp);
+
+        /**
+         * @brief Fills shards from a cache file for every source whose stamp still matches.
+         *
+         * The cache is memory-mapped. Shards that are restored get loaded = true,
+         * the others are left untouched for the caller to parse.
+         *
+         * @param cacheFile Path of the cache file.
+         * @param stamps Current stamps of the listed files.
+         * @param shards One shard per listed file (same order as stamps).
+         * @param fields Columns being loaded, the cache must have been written for the same set.
+         * @return Number of shards restored (0 if the cache is missing, stale, damaged or for other fields).
+         */
+    static int restore(const std::string& cacheFile, const Vector<SourceStamp>& stamps, Vector<LoadShard>& shards,
+                       FieldSet fields);
+
+        /**
+         * @brief Writes all loaded shards with their stamps to a cache file.
+         *
+         * The data is written to a temporary file first and then renamed, so an
+         * interrupted write never leaves a half written cache behind.
+         *
+         * @param cacheFile Path of the cache file.
+         * @param stamps Stamps of the listed files.
+         * @param shards Loaded data of the listed files (same order as stamps).
+         * @param fields Columns the shards were loaded with.
+         * @return True if the cache was written.
+         */
+    static bool save(const std::string& cacheFile, const Vector<SourceStamp>& stamps, const Vector<LoadShard>& shards,
+                     FieldSet fields);
+};
+
+#endif // DATACACHE_H
@@ -2,86 +2,86 @@
  * @file DataUtils.h
  * @author Svetlana Alkhasova
  * @date 18/07/25
- * @version 1.0
+ * @version 1.1
  * @brief Utility functions for filtering, extracting, and manipulating weather data collections.
  */
 
 #ifndef DATAUTILS_H
 #define DATAUTILS_H
 
-#include "WeatherEntry.h"
-#include "BST.h"
-#include <map>
+#include "WeatherLog.h"
+#include "WeatherLogView.h"
+#include "SimdKernels.h"
+#include "MonthTable.h"
 #include <string>
 
 /**
 * @brief Get all records for a specific year/month combination.
 *
 * Returns all weather records for a given year and month.
-* The key is formatted as year month.
+* The month is found by its integer key (year*12 + month-1) with one array
+* access. Nothing is copied or allocated, the view points into dataMap and
+* is valid as long as the table is not changed.
 *
-* @param tree Binary Search Tree holding all date keys as strings.
-* @param dataMap Map from key (string) to WeatherLog (vector of entries).
+* @param dataMap Table of WeatherLogs by month key.
 * @param year  Year to filter (2016).
 * @param month Month to filter (1-12).
-* @return WeatherLog containing the records for the specified year/month.
+* @return View of the records for the specified year/month (empty if none).
 */
-WeatherLog getRecordsByYearMonth(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int year, int month);
+WeatherLogView getRecordsByYearMonth(const MonthTable<WeatherLog>& dataMap, int year, int month);
 
 /**
-* @brief Get all records for a specific month across all years.
+* @brief Gets the wind speeds of a set of weather records.
 *
-* Combines weather records for the given month (all May's),
-* searching over all available years in the tree/map.
+* Returns a view of the records' wind column, nothing is copied.
+* The view is valid as long as records is.
 *
-* @param tree BST of available year-month keys (as year month strings).
-* @param dataMap Map from key (string) to WeatherLog.
-* @param month  Month to filter (1-12).
-* @return WeatherLog containing all records for the given month, all years.
+* @param records Rows to process (a WeatherLog or a view).
+* @return ColumnView<float> of wind speeds.
 */
-WeatherLog getRecordsByMonth(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int month);
+ColumnView<float> extractWindSpeeds(const WeatherLogView& records);
 
 /**
-* @brief Extracts wind speeds from a set of weather records.
+* @brief Gets the air temperatures of weather records.
 *
-* Iterates over the WeatherLog and returns a vector containing
-* only wind speed values.
+* Returns a view of the records' temperature column, nothing is copied.
 *
-* @param records WeatherLog of entries to process.
-* @return Vector<float> of wind speeds.
+* @param records Rows to extract from (a WeatherLog or a view).
+* @return ColumnView<float> of temperatures.
 */
-Vector<float> extractWindSpeeds(const WeatherLog& records);
+ColumnView<float> extractTemperatures(const WeatherLogView& records);
 
 /**
-* @brief Extracts air temperatures from weather records.
+* @brief Gets the solar radiation readings of weather records.
 *
-* Iterates through the WeatherLog and builds a vector of the
-* temperature values found.
+* Returns a view of the whole solar column (including NaN and readings below 100),
+* calculateTotalSolar skips the readings that don't count.
 *
-* @param records WeatherLog to extract from.
-* @return Vector<float> of temperatures.
+* @param records Rows to process (a WeatherLog or a view).
+* @return ColumnView<float> of solar radiation readings.
 */
-Vector<float> extractTemperatures(const WeatherLog& records);
+ColumnView<float> extractSolarRadiation(const WeatherLogView& records);
 
 /**
-* @brief Extracts valid solar radiation values >= 100 from records
+* @brief sums the valid solar radiation values and converts to kWh
 *
-* Includes only solar readings that are 100 or greater.
+* Adds up all readings of 100 W/m^2 or more (NaN skipped), converts the sum
+* to kilowatt-hours, and rounds the result to 1 decimal place.
 *
-* @param records WeatherLog to process.
-* @return Vector<float> of valid solar radiation readings.
+* @param solarVals Solar readings (as from extractSolarRadiation).
+* @return Total radiation in kWh (float, rounded).
 */
-Vector<float> extractSolarRadiation(const WeatherLog& records);
+float calculateTotalSolar(const ColumnView<float>& solarVals);
 
 /**
-* @brief sums all solar radiation values in a vector and converts to kWh
+* @brief Total solar radiation in kWh from an already summed month.
 *
-* Adds up all values, converts the sum to kilowatt-hours, and rounds
-* the result to 1 decimal place.
+* Same result as calculateTotalSolar, for callers that have the sum of the
+* counted readings (like MonthStats::solar).
 *
-* @param solarVals Vector of solar readings.
+* @param counted Count and sum of the readings of 100 W/m^2 or more.
 * @return Total radiation in kWh (float, rounded).
 */
-float calculateTotalSolar(const Vector<float>& solarVals);
+float calculateTotalSolar(const NanSums& counted);
 
 #endif // DATAUTILS_H
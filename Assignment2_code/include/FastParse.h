@@ -0,0 +1,204 @@
+/**
+ * @file FastParse.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Exception-free parsing of the CSV integer, date, time and decimal fields.
+ *
+ * Every function reads a [begin, end) character range (not null terminated) and
+ * returns a ParseStatus instead of throwing, so a bad row costs a return value
+ * and not a stack unwind. The acceptance rules are the loader's:
+ *   - numbers may have leading blanks and a sign, and stop at the first non-digit
+ *   - dates are day/month/year with day 1-31, month 1-12, and must exist in the
+ *     calendar within MIN_STAMP_YEAR..MAX_STAMP_YEAR (see Timestamp.h)
+ *   - times are hour:minute with hour 0-23 and minute 0-59
+ *   - decimals convert like std::strtof: some digits must be read, an overflow
+ *     is an error, anything after the number is ignored
+ *
+ * Plain decimals like "22.75" are converted with one exact float division;
+ * anything else (exponents, "inf", very long digit strings) falls back to
+ * std::strtof, so the result is always the float strtof would give.
+ */
+
+#ifndef FASTPARSE_H
+#define FASTPARSE_H
+
+#include "Timestamp.h"
+#include <climits>
+#include <cmath>
+
+/**
+* @enum ParseStatus
+* @brief Result of a parse.
+**/
+enum ParseStatus {
+    PARSE_OK = 0,   ///< Value read
+    PARSE_EMPTY,    ///< The field is empty
+    PARSE_SYNTAX,   ///< The field is not in the expected format
+    PARSE_RANGE     ///< Well formed, but the value is out of range
+};
+
+    /**
+     * @brief Skips blanks (space, tab, carriage return) like operator>> does before a number.
+     * @param p Position to advance.
+     * @param end End of the field.
+     */
+inline void skipBlanks(const char*& p, const char* end) {
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+}
+
+    /**
+     * @brief Reads an optionally signed integer and moves p past it.
+     * @param p Position to read from, left after the last digit.
+     * @param end End of the field.
+     * @param value Receives the number.
+     * @return PARSE_OK, PARSE_SYNTAX if there are no digits, PARSE_RANGE if it does not fit an int.
+     */
+inline ParseStatus scanInt(const char*& p, const char* end, int& value) {
+    skipBlanks(p, end);
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p == end || static_cast<unsigned>(*p - '0') > 9) return PARSE_SYNTAX;
+    long long v = 0;
+    while (p != end && static_cast<unsigned>(*p - '0') <= 9) {
+        v = v * 10 + (*p - '0');
+        if (v > INT_MAX) return PARSE_RANGE;
+        ++p;
+    }
+    value = static_cast<int>(negative ? -v : v);
+    return PARSE_OK;
+}
+
+    /**
+     * @brief Reads the separator that follows a number (blanks skipped first).
+     * @param p Position to read from, left after the separator.
+     * @param end End of the field.
+     * @param expected The separator character.
+     * @return True if the next non-blank character is the separator.
+     */
+inline bool scanSeparator(const char*& p, const char* end, char expected) {
+    skipBlanks(p, end);
+    if (p == end || *p != expected) return false;
+    ++p;
+    return true;
+}
+
+    /**
+     * @brief Reads a day/month/year date.
+     * @param begin First character of the date.
+     * @param end End of the date.
+     * @param year Receives the year.
+     * @param month Receives the month.
+     * @param day Receives the day.
+     * @return PARSE_OK, PARSE_SYNTAX, or PARSE_RANGE for a date that does not exist or can not be stored.
+     */
+inline ParseStatus scanDate(const char* begin, const char* end, int& year, int& month, int& day) {
+    const char* p = begin;
+    ParseStatus s;
+    if ((s = scanInt(p, end, day)) != PARSE_OK) return s;
+    if (!scanSeparator(p, end, '/')) return PARSE_SYNTAX;
+    if ((s = scanInt(p, end, month)) != PARSE_OK) return s;
+    if (!scanSeparator(p, end, '/')) return PARSE_SYNTAX;
+    if ((s = scanInt(p, end, year)) != PARSE_OK) return s;
+    return isStampDate(year, month, day) ? PARSE_OK : PARSE_RANGE;
+}
+
+    /**
+     * @brief Reads an hour:minute time.
+     * @param begin First character of the time.
+     * @param end End of the time.
+     * @param hour Receives the hour.
+     * @param minute Receives the minute.
+     * @return PARSE_OK, PARSE_SYNTAX, or PARSE_RANGE for hour > 23 or minute > 59.
+     */
+inline ParseStatus scanTime(const char* begin, const char* end, int& hour, int& minute) {
+    const char* p = begin;
+    ParseStatus s;
+    if ((s = scanInt(p, end, hour)) != PARSE_OK) return s;
+    if (!scanSeparator(p, end, ':')) return PARSE_SYNTAX;
+    if ((s = scanInt(p, end, minute)) != PARSE_OK) return s;
+    return (hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59) ? PARSE_OK : PARSE_RANGE;
+}
+
+    /**
+     * @brief Reads a "day/month/year hour:minute" timestamp (split at the first space).
+     * @param begin First character of the field.
+     * @param end End of the field.
+     * @param minutes Receives the time in epoch minutes.
+     * @return PARSE_OK, PARSE_EMPTY, PARSE_SYNTAX or PARSE_RANGE.
+     */
+inline ParseStatus scanTimestamp(const char* begin, const char* end, int& minutes) {
+    if (begin == end) return PARSE_EMPTY;
+    const char* space = begin;
+    while (space != end && *space != ' ') ++space;
+    if (space == end) return PARSE_SYNTAX;
+    int year, month, day, hour, minute;
+    ParseStatus s;
+    if ((s = scanDate(begin, space, year, month, day)) != PARSE_OK) return s;
+    if ((s = scanTime(space + 1, end, hour, minute)) != PARSE_OK) return s;
+    minutes = daysFromCivil(year, month, day) * 1440 + hour * 60 + minute;
+    return PARSE_OK;
+}
+
+    /**
+     * @brief std::strtof on a field that is not null terminated, for the cases scanDecimal leaves to it.
+     * @param begin First character of the field.
+     * @param end End of the field.
+     * @param value Receives the number.
+     * @return PARSE_OK, PARSE_SYNTAX if no number was read, PARSE_RANGE on overflow or underflow.
+     */
+ParseStatus scanDecimalSlow(const char* begin, const char* end, float& value);
+
+    /**
+     * @brief Reads a decimal number, with the same result as std::strtof.
+     *
+     * An empty field gives PARSE_EMPTY and value NaN (a missing reading).
+     *
+     * @param begin First character of the field.
+     * @param end End of the field.
+     * @param value Receives the number.
+     * @return PARSE_OK, PARSE_EMPTY, PARSE_SYNTAX or PARSE_RANGE.
+     */
+inline ParseStatus scanDecimal(const char* begin, const char* end, float& value) {
+    if (begin == end) {
+        value = NAN;
+        return PARSE_EMPTY;
+    }
+    //exact powers of ten as floats, a division by one of them is correctly rounded
+    static const float POW10[11] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    const char* p = begin;
+    skipBlanks(p, end);
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    //up to 7 digits always fit the 24-bit float mantissa exactly
+    unsigned mantissa = 0;
+    int digits = 0, decimals = 0;
+    while (p != end && static_cast<unsigned>(*p - '0') <= 9 && digits < 8) {
+        mantissa = mantissa * 10 + (*p - '0');
+        ++digits;
+        ++p;
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && static_cast<unsigned>(*p - '0') <= 9 && digits < 8) {
+            mantissa = mantissa * 10 + (*p - '0');
+            ++digits;
+            ++decimals;
+            ++p;
+        }
+    }
+    //a plain number that ends here (or at a blank) is exact, everything else goes to strtof
+    if (digits == 0 || digits > 7 || (p != end && *p != ' ' && *p != '\t' && *p != '\r'))
+        return scanDecimalSlow(begin, end, value);
+    float v = static_cast<float>(mantissa) / POW10[decimals];
+    value = negative ? -v : v;
+    return PARSE_OK;
+}
+
+#endif // FASTPARSE_H
@@ -17,12 +17,124 @@
 #include "Date.h"
 #include "MyTime.h"
 #include "Vector.h"
-#include "WeatherEntry.h"
+#include "WeatherLog.h"
 #include "BST.h"
+#include "MonthTable.h"
+#include "MetFields.h"
+#include "ParsePlan.h"
 #include <string>
 #include <map>
 #include <iostream>
 
+/**
+* @struct StageCounters
+* @brief Work done and waits of one stage of the loading pipeline.
+*
+* A stage that often waits on a full output ring is faster than the stage
+* after it; one that often waits on an empty input ring is faster than the
+* stage before it.
+**/
+struct StageCounters {
+    long long blocks;     ///< Blocks the stage passed on
+    long long fullWaits;  ///< Times it had to wait for room in its output ring
+    long long emptyWaits; ///< Times it had to wait for input
+
+    /**
+    * @brief Creates zero counters.
+    */
+    StageCounters() : blocks(0), fullWaits(0), emptyWaits(0) {}
+
+    /**
+    * @brief Adds another stage's counters (like the parser workers').
+    * @param other Counters to add.
+    */
+    void add(const StageCounters& other) {
+        blocks += other.blocks;
+        fullWaits += other.fullWaits;
+        emptyWaits += other.emptyWaits;
+    }
+};
+
+/**
+* @struct PipelineStats
+* @brief Counters of the three stages of FileHandler::parseCSVPipelined.
+**/
+struct PipelineStats {
+    StageCounters reader;  ///< Block reader (or decompressor output)
+    StageCounters parsers; ///< All parser workers together
+    StageCounters indexer; ///< Merge into the month table
+    int parserCount;       ///< Largest number of parser workers used for a file
+
+    /**
+    * @brief Creates zero counters.
+    */
+    PipelineStats() : parserCount(0) {}
+
+    /**
+    * @brief Adds the counters of another load (like another file's).
+    * @param other Counters to add.
+    */
+    void add(const PipelineStats& other) {
+        reader.add(other.reader);
+        parsers.add(other.parsers);
+        indexer.add(other.indexer);
+        if (other.parserCount > parserCount) parserCount = other.parserCount;
+    }
+};
+
+/**
+* @struct FileRows
+* @brief Rows one listed file added to each month, so they can be taken out again.
+**/
+struct FileRows {
+    std::string name;     ///< File name as listed in data_source.txt
+    bool loaded;          ///< True if the file was read
+    MonthTable<int> rows; ///< Number of rows the file added, by month key
+    long long end;        ///< Bytes loaded, up to and including the last newline; following starts here
+
+    /**
+    * @brief Creates an entry for a file that was not read.
+    */
+    FileRows() : loaded(false), end(0) {}
+};
+
+/**
+* @struct LoadOptions
+* @brief Settings for how loadDataFiles reads the listed data files.
+**/
+struct LoadOptions {
+    int threads;           ///< Worker threads, 1 loads serially and 0 means one per core
+    bool useCache;         ///< Restore unchanged files from the binary cache and refresh it
+    std::string cacheFile; ///< Path of the binary cache
+    FieldSet fields;       ///< Columns to load (see MetFields.h), the core ones are always loaded
+    bool lazy;             ///< Only index the files at startup and parse months when queried (see LazyLoader)
+    bool pipeline;         ///< Parse files with parseCSVPipelined instead of parseCSV
+    PipelineStats* pipelineStats; ///< Receives the summed stage counters when pipeline is set (NULL for none)
+    Vector<FileRows>* fileRows;   ///< Receives the rows of every listed file, in list order (NULL for none);
+                                  ///< when set, plain files are only loaded up to their last newline
+
+    /**
+    * @brief Default options: serial loading of everything through data/weather.cache, core columns only.
+    */
+    LoadOptions() : threads(1), useCache(true), cacheFile("data/weather.cache"), fields(CORE_FIELDS), lazy(false),
+                    pipeline(false), pipelineStats(NULL), fileRows(NULL) {}
+};
+
+/**
+* @struct LoadShard
+* @brief Data parsed from one file, kept private to a worker until it is merged.
+**/
+struct LoadShard {
+    BST<int> dateTree;              ///< Month keys found in the file
+    MonthTable<WeatherLog> dataMap; ///< Records of the file by month key
+    bool loaded;                    ///< True if the file was read
+
+    /**
+    * @brief Creates an empty shard.
+    */
+    LoadShard() : loaded(false) {}
+};
+
 
     /**
      * @class FileHandler
@@ -84,28 +196,228 @@ public:
          */
     static int promptMonth();
 
+        /**
+         * @brief Prompts the user for a date and time (dd/mm/yyyy hh:mm), with validation.
+         * @param label What the moment is for, like "start" or "end".
+         * @param date Receives the date.
+         * @param time Receives the time.
+         */
+    static void promptDateTime(const std::string& label, Date& date, MyTime& time);
+
         /**
          * @brief Loads weather data files into the BST and dataMap.
          *
          * Reads all relevant CSV files as specified by the assignment,
          * parsing each and populating the BST and map structures.
          *
-         * @param dateTree BST to store date keys.
-         * @param dataMap Map from date key to WeatherLog.
+         * @param dateTree BST to store month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
          * @return True on success, false on file read error.
          *
          * @pre Data files must exist in the expected location.
          */
-    static bool loadDataFiles(BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap);
+    static bool loadDataFiles(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap);
+
+        /**
+         * @brief Loads weather data files with the given options.
+         *
+         * With the cache enabled, files that are unchanged since the cache was
+         * written are restored from it (see DataCache) and only the others are parsed;
+         * the cache is rewritten whenever a file had to be parsed.
+         * With more than one thread each file to parse is handled by a worker into
+         * its own LoadShard, then the shards are merged in the order the files are
+         * listed, so the result is the same row for row as a serial load.
+         *
+         * @param dateTree BST to store month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param options Load settings (thread count, cache, columns).
+         * @return True if at least one file was loaded, false otherwise.
+         */
+    static bool loadDataFiles(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                              const LoadOptions& options);
+
+        /**
+         * @brief Reads the list of data file names (one per line, blank lines skipped).
+         * @param listFile Path to the list, normally data/data_source.txt.
+         * @param files Receives the file names.
+         * @return True if the list could be opened.
+         */
+    static bool readSourceList(const std::string& listFile, Vector<std::string>& files);
+
+        /**
+         * @brief Appends the records and keys of one shard to the shared structures.
+         *
+         * A month that is not in dataMap yet takes over the shard's log without
+         * copying, so the shard's records should not be used afterwards.
+         *
+         * @param shard Parsed data of one file.
+         * @param dateTree BST receiving the shard's keys.
+         * @param dataMap Table receiving the shard's records (appended after existing ones).
+         */
+    static void mergeShard(LoadShard& shard, BST<int>& dateTree,
+                           MonthTable<WeatherLog>& dataMap);
 
         /**
          * @brief Parses a single CSV file into the BST and dataMap.
+         *
+         * The file is memory-mapped and every row is decoded in place by the
+         * file's ParsePlan, so no per-row strings are allocated. Only WAST, S, T
+         * and SR are loaded. Rows are accepted and skipped by the same rules as
+         * parseCSVStream. Files ending in .gz or .zst are read through
+         * parseCompressedCSV.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap);
+
+        /**
+         * @brief Parses a single CSV file, splitting a large file across threads.
+         *
+         * The rows after the header are cut into byte ranges that start on a line
+         * boundary (at least 1 MB each), every range is parsed on its own thread with
+         * the header's column positions, and the per-chunk logs are merged back in
+         * file order. The result is identical to the single threaded parse.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param threads Maximum number of threads (1 parses on the calling thread).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                         int threads);
+
+        /**
+         * @brief Parses a single CSV file, loading the given columns.
+         *
+         * Same as the threaded parseCSV, but extra columns (like RH or QFE) in
+         * fields are loaded into every month's log as well. Columns that are not
+         * wanted are skipped over without decoding.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param threads Maximum number of threads (1 parses on the calling thread).
+         * @param fields Columns to load (see MetFields.h).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                         int threads, FieldSet fields);
+
+        /**
+         * @brief Parses a single CSV file, optionally only up to its last newline.
+         *
+         * Same as the parseCSV above. With wholeLines set, a last line without
+         * a newline (one a logger is still writing) is left out, and the number
+         * of bytes up to and including the last newline is stored, so the rest
+         * of the file can be followed from exactly there. Compressed files are
+         * always read in full and get 0.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param threads Maximum number of threads (1 parses on the calling thread).
+         * @param fields Columns to load (see MetFields.h).
+         * @param wholeLines Receives the bytes parsed (NULL parses every line).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                         int threads, FieldSet fields, long long* wholeLines);
+
+        /**
+         * @brief Parses a gzip or zstd compressed CSV file while it is being decompressed.
+         *
+         * A CompressedReader decompresses on its own thread and every block is
+         * parsed as soon as it arrives, with lines cut by a block boundary
+         * joined up first. The rows are the same as parseCSV gives for the
+         * uncompressed file. If the data turns out to be damaged nothing is
+         * added and false is returned.
+         *
+         * @param filename Path to a .gz or .zst file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param fields Columns to load (see MetFields.h).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCompressedCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                   FieldSet fields);
+
+        /**
+         * @brief Parses a CSV file with a reader, parser workers and an indexer running at once.
+         *
+         * The reader thread reads the file (or takes the decompressed text of
+         * a .gz or .zst file) in blocks of whole lines and deals them out in
+         * turn to the parser workers. Each parser decodes its blocks into
+         * private logs, and the indexer, on the calling thread, collects the
+         * parsed blocks in file order and is the only one to touch dateTree
+         * and dataMap. The stages are connected by bounded SpscRing queues,
+         * so reading, parsing and indexing overlap and a slow stage makes the
+         * others wait instead of using more memory; the waits are counted in
+         * stats. The rows are the same as parseCSV gives.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param parsers Number of parser workers (at least 1).
+         * @param fields Columns to load (see MetFields.h).
+         * @param stats Receives the counters of this file's stages (added to what it holds).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSVPipelined(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                  int parsers, FieldSet fields, PipelineStats& stats);
+
+        /**
+         * @brief Parses a CSV file in stages, optionally only up to its last newline.
+         *
+         * Same as the parseCSVPipelined above, with wholeLines as in parseCSV.
+         *
+         * @param filename Path to the CSV file.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         * @param parsers Number of parser workers (at least 1).
+         * @param fields Columns to load (see MetFields.h).
+         * @param stats Receives the counters of this file's stages (added to what it holds).
+         * @param wholeLines Receives the bytes parsed (NULL parses every line).
+         * @return True if file successfully read, false otherwise.
+         */
+    static bool parseCSVPipelined(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                  int parsers, FieldSet fields, PipelineStats& stats, long long* wholeLines);
+
+        /**
+         * @brief Prints the pipeline counters, one line per stage.
+         * @param os Output stream.
+         * @param stats Counters to print.
+         */
+    static void printPipelineStats(std::ostream& os, const PipelineStats& stats);
+
+        /**
+         * @brief Parses every line in a buffer range and adds the rows to the structures.
+         * @param begin Start of the first line in the range.
+         * @param end One past the last byte of the range.
+         * @param plan Decode steps built from the file's header.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
+         */
+    static void parseRows(const char* begin, const char* end, const ParsePlan& plan,
+                          BST<int>& dateTree, MonthTable<WeatherLog>& dataMap);
+
+        /**
+         * @brief Parses a single CSV file line by line with std::getline.
+         *
+         * This is the original stream based loader, with the original line
+         * parsing (processCSVLine: string splits, std::stof and exceptions for
+         * bad rows). It keeps the rows parseCSV keeps and is kept as the
+         * reference for comparisons and benchmarks; the program does not use it.
+         *
          * @param filename Path to the CSV file.
-         * @param dateTree BST to store extracted date keys.
-         * @param dataMap Map from date key to WeatherLog.
+         * @param dateTree BST to store extracted month keys.
+         * @param dataMap Table of WeatherLogs by month key (see MonthTable.h).
          * @return True if file successfully read, false otherwise.
          */
-    static bool parseCSV(const std::string& filename, BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap);
+    static bool parseCSVStream(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap);
 
         /**
          * @brief Builds a column name-to-index map from a CSV header line.
@@ -117,16 +429,18 @@ public:
         /**
          * @brief Processes a line from a CSV file and adds entry to data structures.
          *
-         * This helper parses the line, extracts fields, constructs a WeatherEntry,
-         * and updates the BST and dataMap as required.
+         * This is the original line parser used by parseCSVStream: it splits
+         * the line into strings, parses the date and time with parseDate and
+         * parseTime and the values with std::stof, and skips the row when any
+         * of them throws. Only the WAST, S, T and SR columns are read.
          *
          * @param line A single non-header line from the CSV.
          * @param colMap Map from column names to indices (from `buildColumnMap`).
          * @param dateTree BST to update (if new date key is found).
-         * @param dataMap Map from key to WeatherLog to update.
+         * @param dataMap Table of WeatherLogs by month key to update.
          */
     static void processCSVLine(const std::string& line, const std::map<std::string, int>& colMap,
-                               BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap);
+                               BST<int>& dateTree, MonthTable<WeatherLog>& dataMap);
 
         /**
          * @brief Parses a Date from a combined date-time string.
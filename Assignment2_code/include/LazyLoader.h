@@ -0,0 +1,231 @@
+/**
+ * @file LazyLoader.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.1
+ * @brief On-demand loading: index where each month is in the files, parse it when first asked for.
+ *
+ * At startup no values are converted and no rows are stored; only the byte
+ * ranges each year-month covers in each listed file are noted. The month keys
+ * go into the BST right away, so the set of available months is complete (a
+ * month counts when any row has a valid date in it). A month's rows are
+ * parsed into the MonthTable (and its statistics into the MonthIndex) by the
+ * first query that needs them, and kept from then on.
+ *
+ * Station files are written in time order, so a file is first checked at a
+ * few hundred evenly spread rows. If their months never go back, the start
+ * of each month is found by a binary search on the dates, which reads a few
+ * dozen rows per month instead of every row, so startup takes about the same
+ * time for every file however long it is. Otherwise (and if the search finds
+ * months out of order) the date of every row is read instead. A month parsed
+ * from a searched file is checked to hold only rows of that month; if it does
+ * not, the file is indexed row by row after all and the months already
+ * parsed are put right.
+ *
+ * Compressed (.gz, .zst) files have no byte offsets to come back to, so they
+ * are not loaded lazily: they are parsed in full at startup (holding the rows
+ * takes less memory than the text would) and a message says so.
+ */
+
+#ifndef LAZYLOADER_H
+#define LAZYLOADER_H
+
+#include "FileHandler.h"
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "ParsePlan.h"
+#include "MappedFile.h"
+#include "Vector.h"
+#include <map>
+#include <string>
+
+/**
+* @struct LazySource
+* @brief One indexed data file.
+**/
+struct LazySource {
+    std::string path;             ///< Path used to open the file
+    long long size;               ///< File size when it was indexed
+    ParsePlan plan;               ///< Decode steps built from the file's header
+    bool compressed;              ///< A .gz or .zst file, parsed in full at startup
+    bool searched;                ///< Month ranges found by binary search, rows assumed in time order
+    MonthTable<WeatherLog> rows;  ///< Rows of a compressed file by month, until the month is loaded
+
+    /**
+    * @brief Creates an empty source.
+    */
+    LazySource() : size(0), compressed(false), searched(false) {}
+};
+
+/**
+* @struct LazyRange
+* @brief Bytes of one source file that hold rows of one month.
+**/
+struct LazyRange {
+    int source;      ///< Position of the file in the source list
+    long long begin; ///< Offset of the first row
+    long long end;   ///< Offset one past the last row (after its newline)
+    int rows;        ///< Rows the range gave when its month was parsed (-1 before)
+};
+
+/**
+* @struct LazyMonth
+* @brief Where one month's rows are, and whether they have been parsed.
+**/
+struct LazyMonth {
+    Vector<LazyRange> ranges; ///< Byte ranges in list order, files first and offsets second
+    bool loaded;              ///< The rows are in the MonthTable
+
+    /**
+    * @brief Creates a month without ranges that is not loaded.
+    */
+    LazyMonth() : loaded(false) {}
+};
+
+    /**
+     * @class LazyLoader
+     * @brief Parses months of the listed files into the shared structures as queries need them.
+     *
+     * The rows of a month end up in the same order as with loadDataFiles (files
+     * in list order, rows in file order), so every statistic is the same as
+     * after a full load. A loader that was never opened does nothing, so code
+     * can call it whether the data was loaded lazily or not.
+     *
+     * If a file has changed size since it was indexed, its months are not
+     * loaded from it and an error is printed; restart to index it again.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.1
+     * @date 16/10/26
+     */
+class LazyLoader {
+public:
+        /**
+         * @brief Creates a loader that is not open (all load calls do nothing).
+         */
+    LazyLoader();
+
+        /**
+         * @brief Indexes the files listed in data/data_source.txt.
+         *
+         * The structures are kept by reference and filled by the load calls,
+         * they must outlive the loader. The BST gets every indexed month key.
+         *
+         * @param dateTree BST receiving the month keys.
+         * @param dataMap Table the months are parsed into.
+         * @param index Per-month sums, updated as months are parsed.
+         * @param ranges Time range sums, rebuilt when loadRange parses months.
+         * @param options Load settings (thread count for indexing, columns to load; the cache is not used).
+         * @return True if at least one file was indexed.
+         */
+    bool open(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap, MonthIndex& index,
+              RangeIndex& ranges, const LoadOptions& options);
+
+        /**
+         * @brief Tells whether open() succeeded.
+         * @return True if the loader has an index.
+         */
+    bool IsOpen() const;
+
+        /**
+         * @brief Number of indexed months that have not been parsed yet.
+         * @return The count of pending months.
+         */
+    int GetPendingCount() const;
+
+        /**
+         * @brief Makes sure one month is parsed.
+         * @param year Year.
+         * @param month Month (1-12).
+         */
+    void loadMonth(int year, int month);
+
+        /**
+         * @brief Makes sure all months of a year are parsed.
+         * @param year Year.
+         */
+    void loadYear(int year);
+
+        /**
+         * @brief Makes sure one calendar month is parsed in the earliest year that has rows for it.
+         *
+         * The years are parsed in order until one of them gives rows, so a
+         * month whose rows were all rejected does not count.
+         *
+         * @param month Month (1-12).
+         */
+    void loadMonthFirstYear(int month);
+
+        /**
+         * @brief Makes sure every month a time window touches is parsed, and the range index covers them.
+         * @param from Start of the window in epoch minutes.
+         * @param to End of the window in epoch minutes.
+         */
+    void loadRange(int from, int to);
+
+        /**
+         * @brief Parses every pending month.
+         */
+    void loadAll();
+
+        /**
+         * @brief Rebuilds the range index if months were parsed since it was last built.
+         *
+         * loadRange and loadAll do this themselves; call it after loading
+         * months for other queries when a range query reads the index too.
+         */
+    void refreshRanges();
+
+private:
+        /**
+         * @brief Parses one month if it is pending.
+         * @param key Month key (year*12 + month-1).
+         * @return True if the month was parsed by this call.
+         */
+    bool loadKey(int key);
+
+        /**
+         * @brief Adds the rows of one range to a month's log.
+         * @param range The range, its rows count is set here.
+         * @param key Month key of the range.
+         * @param file The range's file, mapped here when a different one is mapped.
+         * @param mapped Source whose file is mapped (-1 for none), updated here.
+         * @param log Receives the rows.
+         * @return False if the range holds rows of another month (its file is not in time order).
+         */
+    bool parseRange(LazyRange& range, int key, MappedFile& file, int& mapped, WeatherLog& log);
+
+        /**
+         * @brief Indexes a searched file row by row after a month turned out to be out of order.
+         *
+         * Parsed months with rows in the file are put together again: their
+         * rows from other files are kept, the ones from this file are parsed
+         * from the new ranges.
+         *
+         * @param source Position of the file in the source list.
+         */
+    void rescan(int source);
+
+        /**
+         * @brief Notes where each month's rows are in one file, or parses it if it is compressed.
+         * @param source The file (path set), its size and plan are filled in here.
+         * @param fields Columns to load.
+         * @param keys Receives the month key of every range, in file order.
+         * @param found Receives the byte ranges (source is left for the caller to set).
+         * @param error Receives the message to print if the file can not be read.
+         * @return False if the file can not be read.
+         */
+    static bool indexFile(LazySource& source, FieldSet fields, Vector<int>& keys, Vector<LazyRange>& found,
+                          std::string& error);
+
+    BST<int>* tree;                           ///< Month keys (not owned)
+    MonthTable<WeatherLog>* data;             ///< Parsed months (not owned)
+    MonthIndex* monthIndex;                   ///< Per-month sums (not owned)
+    RangeIndex* rangeIndex;                   ///< Time range sums (not owned)
+    Vector<LazySource> sources;               ///< Indexed files in list order
+    MonthTable<LazyMonth> months;             ///< Ranges of every indexed month
+    int pendingCount;                         ///< Months with ranges that are not loaded
+    bool rangesStale;                         ///< Months were parsed since the range index was built
+};
+
+#endif // LAZYLOADER_H
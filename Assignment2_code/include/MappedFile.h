@@ -0,0 +1,78 @@
+/**
+ * @file MappedFile.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Used by the CSV loader so file contents can be tokenized in place
+ * without copying every line into a std::string first.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+    /**
+     * @class MappedFile
+     * @brief Maps a file into memory for reading (mmap on POSIX, file mapping on Windows).
+     *
+     * The mapping is released when the object is destroyed or close() is called.
+     * An empty file opens successfully and has size 0 and a NULL data pointer.
+     * Objects can not be copied.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class MappedFile {
+public:
+        /**
+         * @brief Default constructor, nothing is mapped.
+         */
+    MappedFile();
+
+        /**
+         * @brief Destructor, unmaps the file if open.
+         */
+    ~MappedFile();
+
+        /**
+         * @brief Maps the given file read-only.
+         * @param filename Path to the file.
+         * @return True if the file was opened and mapped, false otherwise.
+         */
+    bool open(const std::string& filename);
+
+        /**
+         * @brief Unmaps the file (safe to call when nothing is open).
+         */
+    void close();
+
+        /**
+         * @brief Pointer to the first byte of the file.
+         * @return Start of the mapped bytes, or NULL if empty/not open.
+         */
+    const char* GetData() const;
+
+        /**
+         * @brief Number of bytes mapped.
+         * @return File size in bytes.
+         */
+    std::size_t GetSize() const;
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* data; ///< Start of the mapping
+    std::size_t size; ///< Size of the mapping in bytes
+#ifdef _WIN32
+    void* fileHandle;   ///< Win32 file handle
+    void* mappingHandle;///< Win32 file mapping handle
+#endif
+};
+
+#endif // MAPPEDFILE_H
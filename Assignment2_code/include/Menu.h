@@ -2,7 +2,7 @@
  * @file Menu.h
  * @author Svetlana Alkhasova
  * @date 18/07/25
- * @version 2.1
+ * @version 2.7
  * @brief Defines menu presentation and user interaction logic for the Weather App.
  *
  * Contains static methods for running the main menu, processing user selections, and
@@ -13,16 +13,18 @@
 #define MENU_H
 
 #include "FileHandler.h"
-#include "WeatherEntry.h"
+#include "WeatherLog.h"
 #include "Vector.h"
 #include "Statistics.h"
 #include "DataUtils.h"
-#include "BST.h"
-#include <map>
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "LazyLoader.h"
+#include "ReportEngine.h"
+#include "SnapshotStore.h"
+#include "MonthTable.h"
 #include <string>
 #include <iostream>
-#include <fstream>
-
 
     /**
      * @class Menu
@@ -40,13 +42,43 @@ class Menu {
 public:
         /**
          * @brief Runs the main loop for the menu/user interface.
-         * @param tree BST holding all year-month keys (as strings).
-         * @param dataMap Map from string key to WeatherLog, holding all records.
+         * @param dataMap Table of WeatherLogs by month key, holding all records.
+         * @param index Per-month sums built from dataMap after loading.
+         * @param ranges Time-sorted running sums built from dataMap after loading.
          *
          * Presents the menu, receives user choices, and calls the appropriate functions
          * to display stats or export data, looping until the user exits.
          */
-    static void run(BST<std::string>& tree, std::map<std::string, WeatherLog>& dataMap);
+    static void run(MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges);
+
+        /**
+         * @brief Runs the menu on data that is loaded month by month as it is asked for.
+         * @param dataMap Table of WeatherLogs by month key, filled by lazy.
+         * @param index Per-month sums, filled by lazy.
+         * @param ranges Time-sorted running sums, rebuilt by lazy.
+         * @param lazy Loader that parses the months each option needs before it reads them
+         *        (one that is not open does nothing, for fully loaded data).
+         */
+    static void run(MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges, LazyLoader& lazy);
+
+        /**
+         * @brief Runs the menu on the versions published to a store while the data files change.
+         * @param store Store the ingesting thread publishes to. Each option is answered
+         *        from the version current when it was chosen, and the user is told
+         *        when that is a newer one than the option before.
+         */
+    static void run(SnapshotStore& store);
+
+        /**
+         * @brief Answers one menu option.
+         * @param option The option chosen (1-6, anything else is invalid).
+         * @param dataMap Table of WeatherLogs by month key.
+         * @param index Per-month sums.
+         * @param ranges Time-sorted running sums.
+         * @param lazy Loader for months not parsed yet (one that is not open does nothing).
+         */
+    static void answer(int option, const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges,
+                       LazyLoader& lazy);
 
         /**
          * @brief Prints the main program menu for user selection.
@@ -55,62 +87,66 @@ public:
 
         /**
          * @brief Displays wind statistics (average and std dev) for user-selected month/year.
-         * @param tree BST of valid year-month keys.
-         * @param dataMap Source map for weather logs.
+         * @param index Per-month sums.
+         * @param lazy Loader for the selected month.
          */
-    static void showWindStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap);
+    static void showWindStats(const MonthIndex& index, LazyLoader& lazy);
 
         /**
          * @brief Displays temperature statistics for each month in a user-specified year.
-         * @param tree BST of valid year-month keys.
-         * @param dataMap Map of weather logs keyed by year/month.
+         * @param index Per-month sums.
+         * @param lazy Loader for the months of the year.
          */
-    static void showTempStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap);
+    static void showTempStats(const MonthIndex& index, LazyLoader& lazy);
 
         /**
          * @brief Calculates and displays Pearson correlations between parameters for given month.
-         * @param tree BST of available keys.
-         * @param dataMap WeatherLog data map.
+         *
+         * Uses the readings of that month in the earliest loaded year that has it.
+         *
+         * @param index Per-month sums.
+         * @param lazy Loader for the month in that year.
          */
-    static void showCorrelations(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap);
+    static void showCorrelations(const MonthIndex& index, LazyLoader& lazy);
 
         /**
-         * @brief Writes statistics for a single month to the supplied file.
-         * @param file Output file stream (already open and ready).
-         * @param tree BST of year/month keys.
-         * @param dataMap Map of records.
-         * @param year Year as integer.
-         * @param month Month number (1-12).
+         * @brief Displays wind, temperature, solar and correlation statistics between two user-entered times.
+         *
+         * Both ends are included. The window can cross month and year boundaries.
+         *
+         * @param ranges Time-sorted running sums.
+         * @param lazy Loader for the months the window touches.
          */
-    static void writeMonthStats(std::ofstream& file, const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int year, int month);
+    static void showRangeStats(const RangeIndex& ranges, LazyLoader& lazy);
 
         /**
          * @brief Writes statistics for all months of a specified year to a file.
-         * @param tree BST of keys.
          * @param dataMap WeatherLog records.
+         * @param index Per-month sums.
          * @param filename Output file name.
          * @param year The selected year.
          */
-    static void writeAllStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, const std::string& filename, int year);
+    static void writeAllStats(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const std::string& filename, int year);
 
         /**
          * @brief Handles user interaction and calls the writetofile operation.
-         * @param tree BST of available keys.
-         * @param dataMap WeatherLog map
+         * @param dataMap WeatherLog table
+         * @param index Per-month sums.
+         * @param lazy Loader for the months of the year.
          *
          * prompts user for year and triggers output of statistics to CSV file.
          */
-    static void handleWriteToFile(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap);
+    static void handleWriteToFile(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, LazyLoader& lazy);
 
         /**
          * @brief checks if records exist for a particular month/year or option.
-         * @param records WeatherLog as vector of entries.
+         * @param stats Sums of the selection from the index (NULL if the month is missing).
          * @param month Month number (1-12).
          * @param year  Year as integer.
          * @param option Used to change test logic for different menu actions.
          * @return True if records found for that selection, false otherwise.
          */
-    static bool hasData(const WeatherLog& records, int month, int year, int option);
+    static bool hasData(const MonthStats* stats, int month, int year, int option);
 
         /**
          * @brief Returns the name of a month given its number.
@@ -120,12 +156,11 @@ public:
     static std::string monthName(int month);
 
         /**
-         * @brief Prints the correlation result between two parameter vectors.
-         * @param v1 First data vector.
-         * @param v2 Second data vector.
+         * @brief Prints the correlation result for one pair of parameters.
+         * @param pairs Co-moments of the valid (x, y) pairs.
          * @param label Label for correlation type (S_T, S_R, R_T).
          */
-    static void printCorrelation(const Vector<float>& v1, const Vector<float>& v2, const std::string& label);
+    static void printCorrelation(const CoMomentAcc& pairs, const std::string& label);
 };
 
 
@@ -0,0 +1,122 @@
+/**
+ * @file MetFields.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief The measurement columns of a MetData CSV file and sets of them.
+ *
+ * The files have 18 columns (WAST, DP, Dta, Dts, EV, QFE, QFF, QNH, RF, RH, S,
+ * SR, ST1-ST4, Sx, T) in an order that differs between files. WAST (date and
+ * time), S (wind speed), T (temperature) and SR (solar radiation) are always
+ * loaded; the others are only loaded when asked for, as extra float columns.
+ */
+
+#ifndef METFIELDS_H
+#define METFIELDS_H
+
+#include <string>
+
+/**
+* @enum MetField
+* @brief Known MetData columns, by header name.
+**/
+enum MetField {
+    FIELD_WAST = 0, ///< Date and time (d/mm/yyyy h:mm)
+    FIELD_DP,       ///< Dew point
+    FIELD_DTA,      ///< Wind direction
+    FIELD_DTS,      ///< Wind direction spread
+    FIELD_EV,       ///< Evaporation
+    FIELD_QFE,      ///< Station pressure
+    FIELD_QFF,      ///< Sea level pressure (QFF)
+    FIELD_QNH,      ///< Sea level pressure (QNH)
+    FIELD_RF,       ///< Rainfall
+    FIELD_RH,       ///< Relative humidity
+    FIELD_S,        ///< Wind speed
+    FIELD_SR,       ///< Solar radiation
+    FIELD_ST1,      ///< Soil temperature 1
+    FIELD_ST2,      ///< Soil temperature 2
+    FIELD_ST3,      ///< Soil temperature 3
+    FIELD_ST4,      ///< Soil temperature 4
+    FIELD_SX,       ///< Wind gust
+    FIELD_T,        ///< Air temperature
+    FIELD_COUNT     ///< Number of known columns
+};
+
+/**
+* @brief A set of MetField values, one bit per field.
+**/
+typedef unsigned FieldSet;
+
+    /**
+     * @brief The set holding one field.
+     * @param field A MetField.
+     * @return Its bit.
+     */
+inline FieldSet fieldBit(int field) {
+    return 1u << field;
+}
+
+/**
+* @brief Fields every load reads: WAST, S, T and SR.
+**/
+const FieldSet CORE_FIELDS = (1u << FIELD_WAST) | (1u << FIELD_S) | (1u << FIELD_T) | (1u << FIELD_SR);
+
+/**
+* @brief All known fields.
+**/
+const FieldSet ALL_FIELDS = (1u << FIELD_COUNT) - 1;
+
+    /**
+     * @brief Header name of a field.
+     * @param field A MetField.
+     * @return The name as it appears in the CSV header, like "RH".
+     */
+inline const char* metFieldName(int field) {
+    static const char* const NAMES[FIELD_COUNT] = {
+        "WAST", "DP", "Dta", "Dts", "EV", "QFE", "QFF", "QNH", "RF",
+        "RH", "S", "SR", "ST1", "ST2", "ST3", "ST4", "Sx", "T"
+    };
+    return (field >= 0 && field < FIELD_COUNT) ? NAMES[field] : "";
+}
+
+    /**
+     * @brief Looks up a field by its header name (exact, case sensitive).
+     * @param name Header name.
+     * @return The MetField, or -1 if the name is not a known column.
+     */
+inline int findMetField(const std::string& name) {
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (name == metFieldName(f)) return f;
+    }
+    return -1;
+}
+
+    /**
+     * @brief Reads a comma separated list of header names, like "RH,QFE".
+     *
+     * "all" selects every field. The core fields are always part of the result.
+     *
+     * @param list The names.
+     * @param fields Receives the set.
+     * @return False if a name is not a known column.
+     */
+inline bool parseFieldList(const std::string& list, FieldSet& fields) {
+    fields = CORE_FIELDS;
+    std::string::size_type start = 0;
+    while (start <= list.size()) {
+        std::string::size_type comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        std::string name = list.substr(start, comma - start);
+        if (name == "all") {
+            fields = ALL_FIELDS;
+        } else if (!name.empty()) {
+            int field = findMetField(name);
+            if (field < 0) return false;
+            fields |= fieldBit(field);
+        }
+        start = comma + 1;
+    }
+    return true;
+}
+
+#endif // METFIELDS_H
@@ -0,0 +1,128 @@
+/**
+ * @file MonthIndex.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Per year-month sums built once after loading, so menu statistics don't rescan the rows.
+ *
+ * Count, sum and sum of squares (and the cross sums for the correlations) are
+ * enough to get mean, std dev and Pearson correlation of a month, and they can be
+ * added together to combine months. Mean absolute deviation needs the rows, so
+ * it is still computed from the WeatherLog when a report asks for it.
+ */
+
+#ifndef MONTHINDEX_H
+#define MONTHINDEX_H
+
+#include "WeatherLog.h"
+#include "SimdKernels.h"
+#include "MonthTable.h"
+
+/**
+* @struct MonthStats
+* @brief Sufficient statistics of one month of readings.
+*
+* The solar sums only include readings of 100 W/m^2 or more, the same ones
+* calculateTotalSolar and the S_R / T_R correlations use.
+**/
+struct MonthStats {
+    long long rows;      ///< Number of readings (0 means no data)
+    NanSums wind;        ///< Wind speeds (m/s)
+    NanSums temp;        ///< Temperatures
+    NanSums solar;       ///< Solar readings >= 100
+    CrossSums windTemp;  ///< Pairs for S_T
+    CrossSums windSolar; ///< Pairs for S_R (solar >= 100)
+    CrossSums tempSolar; ///< Pairs for T_R (solar >= 100)
+
+    /**
+    * @brief Creates empty statistics.
+    */
+    MonthStats();
+
+    /**
+    * @brief Sums of all the readings of a log.
+    * @param log Readings of one month.
+    * @return The filled statistics.
+    */
+    static MonthStats build(const WeatherLog& log);
+
+    /**
+    * @brief Adds one reading (NaN values and solar below 100 are left out as in build).
+    * @param wind Wind speed.
+    * @param temp Temperature.
+    * @param solar Solar radiation.
+    */
+    void add(float wind, float temp, float solar);
+
+    /**
+    * @brief Adds the sums of another month (for combining years).
+    * @param other Statistics to add.
+    */
+    void merge(const MonthStats& other);
+
+    /**
+    * @brief Takes away the sums of a subset (the inverse of merge, used with prefix sums).
+    * @param other Statistics of readings that were merged into this one.
+    */
+    void remove(const MonthStats& other);
+};
+
+
+    /**
+     * @class MonthIndex
+     * @brief MonthStats for every loaded year-month, in a MonthTable keyed like the records.
+     *
+     * A lookup is one bounds check and one array access.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class MonthIndex {
+public:
+        /**
+         * @brief Creates an empty index.
+         */
+    MonthIndex();
+
+        /**
+         * @brief Fills the index from the loaded records, replacing any previous content.
+         * @param dataMap Records by month key.
+         */
+    void build(const MonthTable<WeatherLog>& dataMap);
+
+        /**
+         * @brief Recomputes the statistics of one month (used when a month is loaded later).
+         * @param key Month key (year*12 + month-1).
+         * @param log Readings of that month.
+         */
+    void update(int key, const WeatherLog& log);
+
+        /**
+         * @brief Adds newly appended readings to one month's statistics, without rescanning the month.
+         * @param key Month key (year*12 + month-1).
+         * @param rows Readings added to that month since it was indexed.
+         */
+    void add(int key, const WeatherLog& rows);
+
+        /**
+         * @brief Statistics of one month.
+         * @param year Year.
+         * @param month Month (1-12).
+         * @return Pointer to the statistics, NULL if there is no data for that month.
+         */
+    const MonthStats* find(int year, int month) const;
+
+        /**
+         * @brief Statistics of one calendar month in the earliest year that has data for it.
+         * @param month Month (1-12).
+         * @param year Receives that year (left unchanged if no year has the month).
+         * @return Pointer to the statistics, NULL if no year has data for that month.
+         */
+    const MonthStats* firstYear(int month, int& year) const;
+
+private:
+    MonthTable<MonthStats> months; ///< Statistics by month key
+};
+
+#endif // MONTHINDEX_H
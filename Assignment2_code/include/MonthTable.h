@@ -0,0 +1,208 @@
+/**
+ * @file MonthTable.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Integer year-month keys and a direct-offset table of values by month.
+ *
+ * A month is the integer year * 12 + (month - 1), so consecutive months have
+ * consecutive keys and key order is calendar order. Building a key is one
+ * multiply and add, with no strings involved.
+ */
+
+#ifndef MONTHTABLE_H
+#define MONTHTABLE_H
+
+#include "Vector.h"
+#include <utility>
+
+    /**
+     * @brief Integer key of a month.
+     * @param year Year.
+     * @param month Month (1-12).
+     * @return year * 12 + month - 1.
+     */
+inline int monthKey(int year, int month) {
+    return year * 12 + month - 1;
+}
+
+    /**
+     * @brief Year of a month key.
+     * @param key Month key.
+     * @return The year (rounds down, so negative years work too).
+     */
+inline int keyYear(int key) {
+    return key >= 0 ? key / 12 : -((-key + 11) / 12);
+}
+
+    /**
+     * @brief Month of a month key.
+     * @param key Month key.
+     * @return The month (1-12).
+     */
+inline int keyMonth(int key) {
+    return key - keyYear(key) * 12 + 1;
+}
+
+
+    /**
+     * @class MonthTable
+     * @brief Values by month key, found with one array access.
+     *
+     * An offset table covers every key from the first to the last month stored
+     * and holds each month's position in a packed array of values (-1 for months
+     * without a value), so gaps only cost one int per month. Visiting the months
+     * walks the offset table, which gives calendar order.
+     *
+     * Adding a month may move the stored values, pointers and views into them
+     * are only safe once the table is filled.
+     *
+     * @tparam T Type of the value stored per month (like WeatherLog).
+     */
+template <typename T>
+class MonthTable {
+public:
+        /**
+         * @brief Creates an empty table.
+         */
+    MonthTable() : firstKey(0) {}
+
+        /**
+         * @brief Value of a month, added as T() if the month is not in the table yet.
+         * @param key Month key.
+         * @return Reference to the value.
+         */
+    T& operator[](int key) {
+        int at = slotOf(key);
+        if (at < 0) at = insert(key);
+        return values[at];
+    }
+
+        /**
+         * @brief Looks a month up without adding it.
+         * @param key Month key.
+         * @return Pointer to the value, NULL if the month is not in the table.
+         */
+    T* find(int key) {
+        int at = slotOf(key);
+        return at < 0 ? NULL : &values[at];
+    }
+
+        /**
+         * @brief Same as above, for read-only access.
+         */
+    const T* find(int key) const {
+        int at = slotOf(key);
+        return at < 0 ? NULL : &values[at];
+    }
+
+        /**
+         * @brief Number of months in the table.
+         * @return The count of stored months.
+         */
+    int GetCount() const { return values.GetSize(); }
+
+        /**
+         * @brief Smallest key the table covers (only meaningful if GetCount() > 0).
+         * @return First month key.
+         */
+    int GetFirstKey() const { return firstKey; }
+
+        /**
+         * @brief One past the largest key the table covers.
+         * @return End month key (equal to GetFirstKey() when empty).
+         */
+    int GetEndKey() const { return firstKey + offsets.GetSize(); }
+
+        /**
+         * @brief Removes every month.
+         */
+    void Clear() {
+        offsets.Clear();
+        values.Clear();
+        firstKey = 0;
+    }
+
+        /**
+         * @brief Calls visit(key, value) for every stored month in calendar order.
+         * @param visit Function or lambda taking (int, T&).
+         */
+    template <typename Visit>
+    void forEach(Visit visit) {
+        forEach(GetFirstKey(), GetEndKey(), visit);
+    }
+
+        /**
+         * @brief Calls visit(key, value) for every stored month in calendar order.
+         * @param visit Function or lambda taking (int, const T&).
+         */
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        forEach(GetFirstKey(), GetEndKey(), visit);
+    }
+
+        /**
+         * @brief Calls visit(key, value) for the stored months with fromKey <= key < toKey.
+         * @param fromKey First month of the range.
+         * @param toKey Month after the last one of the range.
+         * @param visit Function or lambda taking (int, T&).
+         */
+    template <typename Visit>
+    void forEach(int fromKey, int toKey, Visit visit) {
+        clampRange(fromKey, toKey);
+        for (int key = fromKey; key < toKey; key++) {
+            int at = offsets.GetData()[key - firstKey];
+            if (at >= 0) visit(key, values.GetData()[at]);
+        }
+    }
+
+        /**
+         * @brief Same as above, for read-only access.
+         */
+    template <typename Visit>
+    void forEach(int fromKey, int toKey, Visit visit) const {
+        clampRange(fromKey, toKey);
+        for (int key = fromKey; key < toKey; key++) {
+            int at = offsets.GetData()[key - firstKey];
+            if (at >= 0) visit(key, static_cast<const T&>(values.GetData()[at]));
+        }
+    }
+
+private:
+    //position of a key's value, -1 if absent
+    int slotOf(int key) const {
+        if (key < firstKey || key >= GetEndKey()) return -1;
+        return offsets.GetData()[key - firstKey];
+    }
+
+    //keeps a key range inside the covered keys
+    void clampRange(int& fromKey, int& toKey) const {
+        if (fromKey < firstKey) fromKey = firstKey;
+        if (toKey > GetEndKey()) toKey = GetEndKey();
+    }
+
+    //adds an absent key, widening the offset table if it is outside
+    int insert(int key) {
+        if (offsets.GetSize() == 0) {
+            firstKey = key;
+            offsets.pushBack(-1);
+        } else if (key < firstKey || key >= GetEndKey()) {
+            int newFirst = key < firstKey ? key : firstKey;
+            int newEnd = key >= GetEndKey() ? key + 1 : GetEndKey();
+            Vector<int> wider(newEnd - newFirst, -1);
+            for (int i = 0; i < offsets.GetSize(); i++)
+                wider.GetData()[firstKey - newFirst + i] = offsets.GetData()[i];
+            offsets = std::move(wider);
+            firstKey = newFirst;
+        }
+        offsets.GetData()[key - firstKey] = values.GetSize();
+        values.emplaceBack();
+        return values.GetSize() - 1;
+    }
+
+    int firstKey;       ///< Key of offsets[0]
+    Vector<int> offsets;///< Position in values for each key from firstKey, -1 if absent
+    Vector<T> values;   ///< Stored values, in the order the months were added
+};
+
+#endif // MONTHTABLE_H
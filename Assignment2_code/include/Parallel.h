@@ -0,0 +1,56 @@
+/**
+ * @file Parallel.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Small helper for running independent work items on several threads.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <thread>
+
+    /**
+     * @brief Works out how many threads to use for a thread-count option.
+     * @param requested Requested count, 0 means one per hardware core.
+     * @return Number of threads, at least 1.
+     */
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+    /**
+     * @brief Calls work(i) for every i in [0, count) using up to threads workers.
+     *
+     * Items are handed out one at a time from a shared counter, so a slow item
+     * does not hold up the others. With one thread (or one item) everything runs
+     * on the calling thread. Returns when all items are finished.
+     *
+     * @tparam Work Callable taking an int index.
+     * @param count Number of work items.
+     * @param threads Maximum number of threads to use.
+     * @param work Function called once for each index.
+     */
+template<typename Work>
+void parallelFor(int count, int threads, Work work) {
+    if (threads > count) threads = count;
+    if (threads <= 1) {
+        for (int i = 0; i < count; i++) work(i);
+        return;
+    }
+    std::atomic<int> next(0);
+    std::thread* workers = new std::thread[threads];
+    for (int t = 0; t < threads; t++) {
+        workers[t] = std::thread([&]() {
+            for (int i = next++; i < count; i = next++) work(i);
+        });
+    }
+    for (int t = 0; t < threads; t++) workers[t].join();
+    delete[] workers;
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,85 @@
+/**
+ * @file ParsePlan.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief A CSV header compiled into per-column decode steps.
+ *
+ * The column order differs between files (see data/weather_mixed_columns.csv),
+ * so every file's header is turned into a plan once: for each column position,
+ * skip it or decode it into the timestamp, a WeatherEntry value or an extra
+ * column. Rows are then read left to right in one pass, columns that are not
+ * wanted only cost finding their comma, and nothing after the last wanted
+ * column is looked at.
+ */
+
+#ifndef PARSEPLAN_H
+#define PARSEPLAN_H
+
+#include "MetFields.h"
+#include "Vector.h"
+#include "WeatherEntry.h"
+#include <map>
+#include <string>
+
+    /**
+     * @class ParsePlan
+     * @brief Which columns of a file to decode, and into what.
+     *
+     * A row is accepted under the loader's rules: WAST, S, T and SR must all be
+     * present, a bad timestamp or number in them rejects the row and an empty
+     * measurement is NaN. Extra columns never reject a row; a missing, empty
+     * or unreadable extra value is NaN.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class ParsePlan {
+public:
+    static const unsigned char SKIP = 0xFF; ///< Step for a column that is not decoded
+
+        /**
+         * @brief Creates an empty plan (build() must be called before parseRow()).
+         */
+    ParsePlan();
+
+        /**
+         * @brief Compiles a plan from a file's column map.
+         * @param colMap Map from column names to indices (from FileHandler::buildColumnMap).
+         * @param fields Fields to load, the core fields are always included.
+         *        Wanted fields the file does not have are still listed in
+         *        GetExtraFields() and read as NaN.
+         * @return False if WAST, S, T or SR is missing (every row would be skipped).
+         */
+    bool build(const std::map<std::string, int>& colMap, FieldSet fields);
+
+        /**
+         * @brief Decodes one line.
+         * @param begin First character of the line.
+         * @param end One past the last character (newline not included).
+         * @param entry Receives the timestamp, wind speed, temperature and solar radiation.
+         * @param extras Receives the extra values, indexed by MetField (room for FIELD_COUNT).
+         * @return True if the row is valid, false if it must be skipped.
+         */
+    bool parseRow(const char* begin, const char* end, WeatherEntry& entry, float* extras) const;
+
+        /**
+         * @brief Extra fields the plan fills for every row.
+         * @return The wanted fields besides WAST, S, T and SR.
+         */
+    FieldSet GetExtraFields() const;
+
+        /**
+         * @brief Number of columns the plan reads, up to the last wanted one.
+         * @return Columns read per row.
+         */
+    int GetColumnCount() const;
+
+private:
+    Vector<unsigned char> steps; ///< MetField to decode each column into, or SKIP
+    int lastCore;                ///< Position of the last of the four core columns
+    FieldSet extraFields;        ///< Wanted fields besides the core ones
+};
+
+#endif // PARSEPLAN_H
@@ -0,0 +1,164 @@
+/**
+ * @file RangeIndex.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.2
+ * @brief Statistics over any time window through a sorted timestamp index and block prefix sums.
+ *
+ * All readings are sorted by time once and kept as time, wind, temperature
+ * and solar columns (16 bytes a reading, like WeatherEntry). Every BLOCK
+ * readings the running MonthStats sums are stored, so the sums of a window
+ * are the difference of two stored entries plus the readings of the partly
+ * covered blocks at each end: two binary searches and at most 2 * BLOCK adds,
+ * however long the window is, for about 1/BLOCK of the memory that running
+ * sums at every reading would take.
+ *
+ * The columns and sums are kept in reference counted chunks of CHUNK
+ * readings. Copying the index shares them, and only the last chunk, the one
+ * new readings go to, is copied when a shared index grows. The versions
+ * follow mode publishes (see SnapshotStore.h) so share every full chunk.
+ */
+
+#ifndef RANGEINDEX_H
+#define RANGEINDEX_H
+
+#include "MonthIndex.h"
+#include "WeatherLog.h"
+#include "MonthTable.h"
+#include "Vector.h"
+#include <memory>
+
+    /**
+     * @class RangeIndex
+     * @brief Sorted reading times with running sums, for time range queries.
+     *
+     * Times are epoch minutes (see Timestamp.h). Readings with the same time
+     * (like overlapping data files) are all kept, in load order. Copies can be
+     * read and dropped on any thread, one copy is changed by one thread at a
+     * time.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.2
+     * @date 16/10/26
+     */
+class RangeIndex {
+public:
+    static const int BLOCK = 64;          ///< Readings between two stored running sums
+    static const int CHUNK = 64 * BLOCK;  ///< Readings in one shared chunk
+
+        /**
+         * @brief Creates an empty index.
+         */
+    RangeIndex();
+
+        /**
+         * @brief Fills the index from the loaded records, replacing any previous content.
+         * @param dataMap Records by month key.
+         */
+    void build(const MonthTable<WeatherLog>& dataMap);
+
+        /**
+         * @brief Adds newly loaded readings after the indexed ones.
+         *
+         * Only works when none of the new readings is older than the latest
+         * indexed one (like rows appended to a logger's file); then it costs
+         * the new rows only. Otherwise nothing is changed and the index has
+         * to be built again.
+         *
+         * @param added The new records by month key.
+         * @return False if a new reading is older than GetLastTime().
+         */
+    bool append(const MonthTable<WeatherLog>& added);
+
+        /**
+         * @brief Number of indexed readings.
+         * @return The count of readings.
+         */
+    int GetSize() const;
+
+        /**
+         * @brief Time of the earliest reading.
+         * @return Epoch minutes (only meaningful if GetSize() > 0).
+         */
+    int GetFirstTime() const;
+
+        /**
+         * @brief Time of the latest reading.
+         * @return Epoch minutes (only meaningful if GetSize() > 0).
+         */
+    int GetLastTime() const;
+
+        /**
+         * @brief Sums of the readings taken from one time to another (both included).
+         *
+         * Example: the last 72 hours are query(GetLastTime() - 72 * 60, GetLastTime()).
+         *
+         * @param from Start of the window in epoch minutes.
+         * @param to End of the window in epoch minutes.
+         * @return Sums of the window (rows is 0 if it holds no readings).
+         */
+    MonthStats query(int from, int to) const;
+
+private:
+    /**
+    * @struct Chunk
+    * @brief CHUNK readings in time order (fewer in the last chunk) and their running sums.
+    **/
+    struct Chunk {
+        Vector<int> times;        ///< Reading times in increasing order
+        Vector<float> wind;       ///< Wind speeds in time order
+        Vector<float> temp;       ///< Temperatures in time order
+        Vector<float> solar;      ///< Solar radiation in time order
+        Vector<MonthStats> sums;  ///< sums[k] holds the sums of every reading up to the end of block k of the chunk
+    };
+
+        /**
+         * @brief First reading at or after a time.
+         * @param minute Epoch minutes.
+         * @return Position of the reading (GetSize() if all readings are earlier).
+         */
+    int lowerBound(int minute) const;
+
+        /**
+         * @brief Running sums at a block boundary.
+         * @param block Block number, 0 to GetSize() / BLOCK.
+         * @return Sums of the first block * BLOCK readings.
+         */
+    MonthStats sumsBefore(int block) const;
+
+        /**
+         * @brief Time of one reading.
+         * @param at Position of the reading.
+         * @return Epoch minutes.
+         */
+    int timeAt(int at) const;
+
+        /**
+         * @brief The chunk new readings go to, copied first if another index shares it.
+         * @return The last chunk, started if the last one is full.
+         */
+    Chunk& tail();
+
+        /**
+         * @brief Adds readings one by one.
+         * @param stats Sums the readings are added to.
+         * @param first Position of the first reading.
+         * @param last Position after the last reading (may be in a later chunk).
+         */
+    void addReadings(MonthStats& stats, int first, int last) const;
+
+        /**
+         * @brief Adds a reading at the end, storing the running sums when a block is full.
+         * @param when Reading time in epoch minutes (not before GetLastTime()).
+         * @param w Wind speed.
+         * @param t Temperature.
+         * @param r Solar radiation.
+         * @param running Sums of all readings so far, the new one is added to it.
+         */
+    void pushReading(int when, float w, float t, float r, MonthStats& running);
+
+    Vector<std::shared_ptr<Chunk> > chunks; ///< All readings, CHUNK to a chunk, shared by copies of the index
+    int count;                              ///< Number of readings
+};
+
+#endif // RANGEINDEX_H
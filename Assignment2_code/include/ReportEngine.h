@@ -0,0 +1,149 @@
+/**
+ * @file ReportEngine.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Writes the WindTempSolar statistics of many years in one run.
+ *
+ * Menu option 4 writes one year to WindTempSolar.csv. The report engine
+ * produces the same text for every year of the data, or a range of years,
+ * either as one file per year or all years in one combined file. The
+ * months are worked out in parallel, then every file is put together in
+ * memory and written with a single write.
+ */
+
+#ifndef REPORTENGINE_H
+#define REPORTENGINE_H
+
+#include "LazyLoader.h"
+#include "MonthIndex.h"
+#include "WeatherLog.h"
+#include "BST.h"
+#include "MonthTable.h"
+#include "Vector.h"
+#include <string>
+
+/**
+* @struct MonthReport
+* @brief The values of one month's line in WindTempSolar.csv.
+**/
+struct MonthReport {
+    float windAvg;    ///< Average wind speed (km/h)
+    float windStdev;  ///< Standard deviation of the wind speed (km/h)
+    float windMad;    ///< Mean absolute deviation of the wind speed (km/h)
+    float tempAvg;    ///< Average temperature (degree C)
+    float tempStdev;  ///< Standard deviation of the temperature
+    float tempMad;    ///< Mean absolute deviation of the temperature
+    float solarTotal; ///< Total solar radiation (kWh/m^2)
+};
+
+/**
+* @struct ReportOptions
+* @brief Which years to report and where to write them.
+**/
+struct ReportOptions {
+    int firstYear;        ///< First year to report, 0 for the first year with data
+    int lastYear;         ///< Last year to report, 0 for the last year with data
+    bool perYear;         ///< One file per year instead of one combined file
+    std::string filename; ///< Combined file, or the name the year is added to (WindTempSolar_2007.csv)
+    int threads;          ///< Worker threads, 0 means one per core
+
+    /**
+    * @brief Default options: every year with data, combined into WindTempSolar.csv, one thread.
+    */
+    ReportOptions() : firstYear(0), lastYear(0), perYear(false), filename("WindTempSolar.csv"), threads(1) {}
+};
+
+    /**
+     * @class ReportEngine
+     * @brief Static utility class that works out and writes the yearly WindTempSolar reports.
+     *
+     * Every year is written exactly like Menu::writeAllStats writes it: the
+     * year, then one line per month that is in the index, or "No Data" if
+     * the year has none. In a combined file the years follow each other,
+     * each ending in a newline.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class ReportEngine {
+public:
+        /**
+         * @brief Works out the report values of one month.
+         * @param dataMap Table of records (only read for the mean absolute deviations).
+         * @param stats Sums of the month from the index.
+         * @param year Year as integer.
+         * @param month Month number (1-12).
+         * @return The values, NaN where the month has no valid readings.
+         */
+    static MonthReport monthReport(const MonthTable<WeatherLog>& dataMap, const MonthStats& stats, int year, int month);
+
+        /**
+         * @brief Appends one month's line, as in WindTempSolar.csv.
+         * @param out Text to append to.
+         * @param report Values of the month.
+         * @param month Month number (1-12).
+         */
+    static void formatMonth(std::string& out, const MonthReport& report, int month);
+
+        /**
+         * @brief Puts together the text of several years.
+         *
+         * Months are worked out on the given number of threads; the text is
+         * the same whatever the number.
+         *
+         * @param dataMap Table of WeatherLogs by month key.
+         * @param index Per-month sums.
+         * @param firstYear First year.
+         * @param lastYear Last year (included).
+         * @param threads Worker threads, 0 means one per core.
+         * @param years Receives the text of each year, firstYear first.
+         */
+    static void buildYears(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, int firstYear, int lastYear,
+                           int threads, Vector<std::string>& years);
+
+        /**
+         * @brief Writes the reports chosen by the options.
+         *
+         * With both years left at 0, only years that have data are written.
+         * The months are loaded through lazy first (one that is not open does
+         * nothing). Each file written and the time taken are printed to
+         * std::cerr, so batch results on std::cout stay clean.
+         *
+         * @param tree BST holding all month keys.
+         * @param dataMap Table of WeatherLogs by month key.
+         * @param index Per-month sums.
+         * @param lazy Loader for the years to report.
+         * @param options Years, files and threads.
+         * @return False if there is nothing to report or a file could not be written.
+         */
+    static bool write(const BST<int>& tree, const MonthTable<WeatherLog>& dataMap, const MonthIndex& index,
+                      LazyLoader& lazy, const ReportOptions& options);
+
+        /**
+         * @brief Name of one year's file, the year added before the extension.
+         * @param filename Base name, like WindTempSolar.csv.
+         * @param year The year.
+         * @return The name, like WindTempSolar_2007.csv.
+         */
+    static std::string yearFileName(const std::string& filename, int year);
+
+        /**
+         * @brief Reads a year selection: "all", a year, or two years joined by '-'.
+         * @param text The selection.
+         * @param options Receives firstYear and lastYear (0 and 0 for all).
+         * @return False if the text is not a valid selection.
+         */
+    static bool parseYears(const std::string& text, ReportOptions& options);
+
+        /**
+         * @brief Writes a whole text to a file in one go.
+         * @param filename Path of the file (replaced if it exists).
+         * @param text Contents.
+         * @return False if the file could not be written.
+         */
+    static bool writeFile(const std::string& filename, const std::string& text);
+};
+
+#endif // REPORTENGINE_H
@@ -0,0 +1,180 @@
+/**
+ * @file SnapshotStore.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.1
+ * @brief Immutable versions of the loaded data, published so queries never wait for ingestion.
+ *
+ * In follow mode the data changes while queries run. Instead of locking the
+ * BST, the month table and the indexes, the ingesting thread works on its
+ * own copy and, once a change is complete, publishes a new read-only version
+ * with a single atomic pointer swap. A query pins the version that is current
+ * when it starts and reads it to the end, whatever is published meanwhile.
+ *
+ * A version is a plain copy of the ingester's data, but the month logs and
+ * the range index chunks are reference counted (see WeatherLog.h and
+ * RangeIndex.h), so the copy shares them. When the ingester then changes a
+ * month, that month's log is copied first and the published versions keep
+ * the old one. A publish so costs a copy of the BST, the month index and
+ * one pointer per month and per index chunk, plus the months and the last
+ * index chunk the change touched.
+ *
+ * Versions are freed by epochs: every publish moves the epoch on, and a
+ * version replaced at epoch E is freed once no reader is still pinned at
+ * epoch E or before. Pinning is a load and two stores with no loop, so
+ * readers never wait, not even for each other.
+ */
+
+#ifndef SNAPSHOTSTORE_H
+#define SNAPSHOTSTORE_H
+
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "WeatherLog.h"
+#include "BST.h"
+#include "MonthTable.h"
+#include "Vector.h"
+#include <atomic>
+
+/**
+* @struct DataSnapshot
+* @brief One complete version of the loaded data.
+**/
+struct DataSnapshot {
+    BST<int> dateTree;              ///< Month keys
+    MonthTable<WeatherLog> dataMap; ///< Records by month key
+    MonthIndex monthIndex;          ///< Per-month sums
+    RangeIndex rangeIndex;          ///< Time-sorted running sums
+    long long version;              ///< Number of the version, counting from 1
+    long long readings;             ///< Number of rows in dataMap
+
+    /**
+    * @brief Creates an empty version 0.
+    */
+    DataSnapshot() : version(0), readings(0) {}
+};
+
+    /**
+     * @class SnapshotStore
+     * @brief Holds the current DataSnapshot and frees replaced ones once no reader can see them.
+     *
+     * There is one publishing thread at a time (the ingester) and any number
+     * of threads reading through their own Reader, up to MAX_READERS at once.
+     * Work that a reader hands to other threads (like parallelFor in the batch
+     * runner) is covered by that reader's pin.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.0
+     * @date 16/10/26
+     */
+class SnapshotStore {
+public:
+    static const int MAX_READERS = 64; ///< Readers that can exist at the same time
+
+        /**
+         * @class Reader
+         * @brief One thread's access to the store.
+         *
+         * A Reader is used by one thread at a time. acquire() pins the current
+         * version, which stays valid until release() (or the next acquire()).
+         */
+    class Reader {
+    public:
+            /**
+             * @brief Takes a free reader slot of the store.
+             * @param store The store to read from.
+             * @throws std::runtime_error if MAX_READERS readers exist already.
+             */
+        explicit Reader(SnapshotStore& store);
+
+            /**
+             * @brief Releases the pin and the slot.
+             */
+        ~Reader();
+
+            /**
+             * @brief Pins the current version (releasing any earlier pin).
+             * @return The version, valid until release().
+             */
+        const DataSnapshot& acquire();
+
+            /**
+             * @brief Lets the pinned version be freed once it is replaced.
+             */
+        void release();
+
+    private:
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+
+        SnapshotStore& store; ///< Store read from
+        int slot;             ///< Slot holding this reader's pinned epoch
+    };
+
+        /**
+         * @brief Creates a store holding an empty version 0.
+         */
+    SnapshotStore();
+
+        /**
+         * @brief Frees every version (no Reader may be left).
+         */
+    ~SnapshotStore();
+
+        /**
+         * @brief Makes a version the current one, publishing thread only.
+         *
+         * The version gets the next version number. The one it replaces is
+         * freed as soon as no reader can be reading it, possibly right away.
+         *
+         * @param next The new version, owned by the store from now on.
+         */
+    void publish(DataSnapshot* next);
+
+        /**
+         * @brief Frees replaced versions that no reader is pinned to any more, publishing thread only.
+         *
+         * publish() does this too; an ingester that has nothing new to publish
+         * can call it to free versions whose readers have finished since.
+         *
+         * @return Number of versions still waiting for readers.
+         */
+    int reclaim();
+
+        /**
+         * @brief Number of the current version, to check for news without pinning.
+         * @return The version number (0 before the first publish).
+         */
+    long long GetVersion() const;
+
+private:
+    SnapshotStore(const SnapshotStore&);
+    SnapshotStore& operator=(const SnapshotStore&);
+
+    /**
+    * @struct Slot
+    * @brief Epoch one reader is pinned at, on its own cache line.
+    **/
+    struct alignas(64) Slot {
+        std::atomic<bool> used;                  ///< A Reader owns the slot
+        std::atomic<unsigned long long> pinned;  ///< Epoch the reader pinned at, 0 when not reading
+    };
+
+    /**
+    * @struct Retired
+    * @brief A replaced version waiting for its readers.
+    **/
+    struct Retired {
+        const DataSnapshot* snapshot; ///< The version
+        unsigned long long epoch;     ///< Last epoch in which it was current
+    };
+
+    std::atomic<const DataSnapshot*> current; ///< Version new readers get
+    std::atomic<long long> currentVersion;    ///< current->version, readable without pinning
+    std::atomic<unsigned long long> epoch;    ///< Moved on by every publish, starts at 1
+    Slot slots[MAX_READERS];                  ///< Reader pins
+    Vector<Retired> retired;                  ///< Replaced versions not freed yet (publisher only)
+    long long nextVersion;                    ///< Number for the next publish (publisher only)
+};
+
+#endif // SNAPSHOTSTORE_H
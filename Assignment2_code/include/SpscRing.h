@@ -0,0 +1,102 @@
+/**
+ * @file SpscRing.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.0
+ * @brief Bounded lock-free queue between one producer thread and one consumer thread.
+ *
+ * Used to connect the stages of the loading pipeline. With a single writer
+ * per index no locks or compare-and-swap loops are needed: the producer only
+ * moves the tail, the consumer only moves the head, and each publishes its
+ * index with a release store that the other side reads with an acquire load.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+
+    /**
+     * @class SpscRing
+     * @brief Fixed size ring buffer for exactly one pushing and one popping thread.
+     *
+     * Neither call ever waits: tryPush fails when the ring is full and tryPop
+     * when it is empty, so the caller decides how to wait (and can count it).
+     * Each side keeps a copy of the other side's index and only reloads it
+     * when the copy says the ring is full or empty, so the two threads do not
+     * keep pulling each other's cache line.
+     *
+     * @tparam T Type of the items, copied in and out (pointers in the loader).
+     */
+template <typename T>
+class SpscRing {
+public:
+        /**
+         * @brief Creates an empty ring.
+         * @param capacity Items the ring can hold, rounded up to a power of two.
+         */
+    explicit SpscRing(int capacity) : head(0), cachedTail(0), tail(0), cachedHead(0) {
+        int size = 1;
+        while (size < capacity) size *= 2;
+        mask = size - 1;
+        slots = new T[size];
+    }
+
+    ~SpscRing() {
+        delete[] slots;
+    }
+
+        /**
+         * @brief Adds an item, producer thread only.
+         * @param item Item to add.
+         * @return False if the ring is full.
+         */
+    bool tryPush(const T& item) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > static_cast<unsigned>(mask)) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > static_cast<unsigned>(mask)) return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+        /**
+         * @brief Takes the oldest item, consumer thread only.
+         * @param item Receives the item.
+         * @return False if the ring is empty.
+         */
+    bool tryPop(T& item) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+        /**
+         * @brief Number of items the ring can hold.
+         * @return The capacity.
+         */
+    int GetCapacity() const {
+        return mask + 1;
+    }
+
+private:
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+
+    T* slots; ///< Storage, indexed by position & mask
+    int mask; ///< Capacity - 1
+    //the two sides write different lines, so pushing does not slow popping down
+    alignas(64) std::atomic<unsigned> head; ///< Next position to pop (written by the consumer)
+    unsigned cachedTail;                    ///< Consumer's last look at tail
+    alignas(64) std::atomic<unsigned> tail; ///< Next position to push (written by the producer)
+    unsigned cachedHead;                    ///< Producer's last look at head
+};
+
+#endif // SPSCRING_H
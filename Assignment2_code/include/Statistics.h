@@ -2,17 +2,30 @@
  * @file Statistics.h
  * @author Svetlana Alkhasova
  * @date 18/07/25
- * @version 2.0
+ * @version 2.3
  * @brief Some basic statistics functions for working with vectors in this assignment.
  *
  * Here are helpers for mean, standard deviation, Pearson correlation, and rounding.
  * All of these skip NaN values so they work okay with incomplete data.
+ * They take any container with GetSize() and operator[], so a Vector or a
+ * ColumnView straight out of a WeatherLog both work.
+ *
+ * The accumulators at the end (CountAcc, MeanVarAcc, MinMaxAcc, CoMomentAcc) can be
+ * combined with Accumulator<...> so several statistics come out of a single loop.
+ * Filled with add() and merge() they are Welford/Chan stable. The month index,
+ * the range index and the ColumnView overloads build them with fromSums()
+ * from plain sums instead, which is less precise (see MeanVarAcc::fromSums).
+ *
+ * mean, stdev and pearson on a ColumnView<float> (a WeatherLog column) use the
+ * vectorised kernels from SimdKernels.h instead of the generic loops.
  */
 
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
 #include "Vector.h"
+#include "ColumnView.h"
+#include "SimdKernels.h"
 #include <cmath>
 #include <stdexcept>
 
@@ -42,12 +55,12 @@ T RoundVal(T val, int n) {
      * Loops through the numbers and divides by how many were valid (not NaN).
      * Gives NaN if the vector is empty or totally full of NaNs.
      *
-     * @tparam T Numeric type in your vector (probably float).
+     * @tparam Container Vector or ColumnView of a numeric type (probably float).
      * @param data Vector of values.
      * @return The average, or NaN if no valid values.
      */
-template<typename T>
-float mean(const Vector<T>& data) {
+template<typename Container>
+float mean(const Container& data) {
     float sum = 0.0f; int n = 0;
     for(int i=0;i<data.GetSize();i++) {
         float v = data[i];
@@ -63,12 +76,12 @@ float mean(const Vector<T>& data) {
      * Useful for showing the "spread" of your data.
      * Returns NaN if there are fewer than 2 valid numbers.
      *
-     * @tparam T Numeric type in the vector.
+     * @tparam Container Vector or ColumnView of a numeric type.
      * @param data Vector of numbers.
      * @return Standard deviation, or NaN if not enough data.
      */
-template<typename T>
-float stdev(const Vector<T>& data) {
+template<typename Container>
+float stdev(const Container& data) {
     int n = 0; float avg = mean(data), sum2 = 0.0f;
     if(std::isnan(avg)) return NAN;
     for(int i=0;i<data.GetSize();i++) {
@@ -87,14 +100,14 @@ float stdev(const Vector<T>& data) {
      * Throws an invalid_argument if the vectors are different lengths or empty.
      * Returns NaN if there aren't enough valid pairs to calculate, and rounds the result to two decimals.
      *
-     * @tparam T Numeric type (float).
+     * @tparam Container Vector or ColumnView of a numeric type (float).
      * @param x First vector.
      * @param y Second vector.
      * @return Correlation coefficient (rounded to 2 decimals), or NaN/0 for special cases.
      * @throws std::invalid_argument if vector sizes don't match.
      */
-template<typename T>
-float pearson(const Vector<T>& x, const Vector<T>& y) {
+template<typename Container>
+float pearson(const Container& x, const Container& y) {
     if(x.GetSize() != y.GetSize() || x.GetSize() == 0)
         throw std::invalid_argument("Vector dimensions mismatch");
     float sumX=0, sumY=0, sumXY=0, sumX2=0, sumY2=0;
@@ -115,4 +128,359 @@ float pearson(const Vector<T>& x, const Vector<T>& y) {
     return denom == 0 ? 0.0f : RoundVal(num/denom, 2);
 }
 
+
+    /**
+     * @struct CountAcc
+     * @brief Counts the values it is given (callers skip NaN before add).
+     */
+struct CountAcc {
+    long long count; ///< Number of values added
+
+        /**
+         * @brief Creates an empty count.
+         */
+    CountAcc() : count(0) {}
+
+        /**
+         * @brief Counts one value.
+         */
+    void add(double) { count++; }
+
+        /**
+         * @brief Adds the count of another accumulator.
+         * @param other Count of other values.
+         */
+    void merge(const CountAcc& other) { count += other.count; }
+};
+
+
+    /**
+     * @struct MeanVarAcc
+     * @brief Running mean and variance (Welford's method), in double precision.
+     *
+     * Stable even for long series where a plain sum of squares would lose digits.
+     * Two accumulators can be merged (Chan's formula), so parts of the data can
+     * be done separately and combined. One made by fromSums() is only as
+     * precise as the sums it came from.
+     */
+struct MeanVarAcc {
+    long long n; ///< Number of values added
+    double avg;  ///< Mean so far
+    double m2;   ///< Sum of squared differences from the mean
+
+        /**
+         * @brief Creates an empty accumulator.
+         */
+    MeanVarAcc() : n(0), avg(0.0), m2(0.0) {}
+
+        /**
+         * @brief Builds the accumulator from plain sums (like the nanSums() kernel output).
+         *
+         * The variance is sum of squares minus sum times mean, so digits cancel
+         * when the mean is large next to the spread. The sums are doubles of
+         * float readings, and on the station columns the std dev agrees with
+         * add() to about 1e-9 (relative); the error grows with (mean/spread)^2
+         * and reaches about 5e-4 for a million readings of 101300 +- 0.5.
+         * Plain sums are kept because they add up in SIMD lanes and, in the
+         * range index, can be subtracted from each other.
+         *
+         * @param sums Count, sum and sum of squares of the values.
+         * @return Accumulator holding the same mean and variance.
+         */
+    static MeanVarAcc fromSums(const NanSums& sums) {
+        MeanVarAcc acc;
+        if (sums.count == 0) return acc;
+        acc.n = sums.count;
+        acc.avg = sums.sum / sums.count;
+        acc.m2 = sums.sumSq - sums.sum * acc.avg;
+        if (acc.m2 < 0.0) acc.m2 = 0.0; //rounding when all values are equal
+        return acc;
+    }
+
+        /**
+         * @brief Adds one value (Welford's update).
+         * @param v The value, not NaN.
+         */
+    void add(double v) {
+        n++;
+        double delta = v - avg;
+        avg += delta / n;
+        m2 += delta * (v - avg);
+    }
+
+        /**
+         * @brief Adds the values of another accumulator (Chan's formula).
+         * @param other Mean and variance of other values.
+         */
+    void merge(const MeanVarAcc& other) {
+        if (other.n == 0) return;
+        if (n == 0) { *this = other; return; }
+        long long total = n + other.n;
+        double delta = other.avg - avg;
+        avg += delta * other.n / total;
+        m2 += other.m2 + delta * delta * n * other.n / total;
+        n = total;
+    }
+
+        /**
+         * @brief Mean of the values.
+         * @return The mean, or NaN if nothing was added.
+         */
+    double getMean() const { return n > 0 ? avg : NAN; }
+
+        /**
+         * @brief Sample variance (divides by n-1).
+         * @return The variance, or NaN for fewer than 2 values.
+         */
+    double getVariance() const { return n > 1 ? m2 / (n - 1) : NAN; }
+
+        /**
+         * @brief Sample standard deviation.
+         * @return The standard deviation, or NaN for fewer than 2 values.
+         */
+    double getStdev() const { return n > 1 ? std::sqrt(m2 / (n - 1)) : NAN; }
+};
+
+
+    /**
+     * @struct MinMaxAcc
+     * @brief Smallest and largest value seen.
+     */
+struct MinMaxAcc {
+    double minValue; ///< Smallest value (NaN while empty)
+    double maxValue; ///< Largest value (NaN while empty)
+
+        /**
+         * @brief Creates an accumulator that has seen nothing.
+         */
+    MinMaxAcc() : minValue(NAN), maxValue(NAN) {}
+
+        /**
+         * @brief Takes one value into account.
+         * @param v The value, not NaN.
+         */
+    void add(double v) {
+        if (!(v >= minValue)) minValue = v; //also true while minValue is NaN
+        if (!(v <= maxValue)) maxValue = v;
+    }
+
+        /**
+         * @brief Takes the range of another accumulator into account.
+         * @param other Smallest and largest of other values.
+         */
+    void merge(const MinMaxAcc& other) {
+        if (!std::isnan(other.minValue)) add(other.minValue);
+        if (!std::isnan(other.maxValue)) add(other.maxValue);
+    }
+};
+
+
+    /**
+     * @struct CoMomentAcc
+     * @brief Running means, variances and co-moment of (x, y) pairs for Pearson correlation.
+     *
+     * Works like MeanVarAcc but on pairs, so the correlation comes out of one pass.
+     * fromSums() has the same precision limit as MeanVarAcc::fromSums.
+     */
+struct CoMomentAcc {
+    long long n;     ///< Number of pairs added
+    double avgX;     ///< Mean of x
+    double avgY;     ///< Mean of y
+    double m2X;      ///< Sum of squared differences of x from its mean
+    double m2Y;      ///< Sum of squared differences of y from its mean
+    double coMoment; ///< Sum of (x - mean x)(y - mean y)
+
+        /**
+         * @brief Creates an empty accumulator.
+         */
+    CoMomentAcc() : n(0), avgX(0.0), avgY(0.0), m2X(0.0), m2Y(0.0), coMoment(0.0) {}
+
+        /**
+         * @brief Builds the accumulator from plain cross sums (like the nanCrossSums() kernel output).
+         * @param sums Count and sums of x, y, x*x, y*y and x*y.
+         * @return Accumulator holding the same means and co-moments.
+         */
+    static CoMomentAcc fromSums(const CrossSums& sums) {
+        CoMomentAcc acc;
+        if (sums.count == 0) return acc;
+        acc.n = sums.count;
+        acc.avgX = sums.sumX / sums.count;
+        acc.avgY = sums.sumY / sums.count;
+        acc.m2X = sums.sumXX - sums.sumX * acc.avgX;
+        acc.m2Y = sums.sumYY - sums.sumY * acc.avgY;
+        acc.coMoment = sums.sumXY - sums.sumX * acc.avgY;
+        if (acc.m2X < 0.0) acc.m2X = 0.0; //rounding when all values are equal
+        if (acc.m2Y < 0.0) acc.m2Y = 0.0;
+        return acc;
+    }
+
+        /**
+         * @brief Adds one pair.
+         * @param x Value of the first variable, not NaN.
+         * @param y Value of the second variable, not NaN.
+         */
+    void add(double x, double y) {
+        n++;
+        double dx = x - avgX;
+        avgX += dx / n;
+        double dy = y - avgY;
+        avgY += dy / n;
+        m2X += dx * (x - avgX);
+        m2Y += dy * (y - avgY);
+        coMoment += dx * (y - avgY);
+    }
+
+        /**
+         * @brief Adds the pairs of another accumulator.
+         * @param other Means and co-moments of other pairs.
+         */
+    void merge(const CoMomentAcc& other) {
+        if (other.n == 0) return;
+        if (n == 0) { *this = other; return; }
+        long long total = n + other.n;
+        double dx = other.avgX - avgX, dy = other.avgY - avgY;
+        double weight = static_cast<double>(n) * other.n / total;
+        avgX += dx * other.n / total;
+        avgY += dy * other.n / total;
+        m2X += other.m2X + dx * dx * weight;
+        m2Y += other.m2Y + dy * dy * weight;
+        coMoment += other.coMoment + dx * dy * weight;
+        n = total;
+    }
+};
+
+
+    /**
+     * @class Accumulator
+     * @brief Combines several value accumulators into one, decided at compile time.
+     *
+     * Accumulator<MeanVarAcc, MinMaxAcc> has both as base classes and add() feeds
+     * a value to each of them, so the compiler produces one loop that updates all.
+     * Use get<MeanVarAcc>() to read one part back.
+     *
+     * @tparam Accs Accumulator types with add(double) and merge().
+     */
+template<typename... Accs>
+class Accumulator : public Accs... {
+public:
+        /**
+         * @brief Adds one value to every part.
+         * @param v The value, not NaN.
+         */
+    void add(double v) { (Accs::add(v), ...); }
+
+        /**
+         * @brief Merges every part with the same part of another accumulator.
+         * @param other Accumulator of other values.
+         */
+    void merge(const Accumulator& other) { (Accs::merge(static_cast<const Accs&>(other)), ...); }
+
+        /**
+         * @brief One part of the accumulator.
+         * @tparam Acc The part's type, one of Accs.
+         * @return Reference to that part.
+         */
+    template<typename Acc>
+    const Acc& get() const { return static_cast<const Acc&>(*this); }
+};
+
+
+    /**
+     * @brief Runs every accumulator over the non-NaN values of data in a single pass.
+     *
+     * Example: accumulate<MeanVarAcc, MinMaxAcc>(temps).get<MeanVarAcc>().getMean()
+     *
+     * @tparam Accs Accumulators to combine.
+     * @tparam Container Vector or ColumnView of a numeric type.
+     * @param data Values (NaN skipped).
+     * @return The filled accumulator.
+     */
+template<typename... Accs, typename Container>
+Accumulator<Accs...> accumulate(const Container& data) {
+    Accumulator<Accs...> acc;
+    for(int i=0;i<data.GetSize();i++) {
+        float v = data[i];
+        if(!std::isnan(v)) acc.add(v);
+    }
+    return acc;
+}
+
+
+    /**
+     * @brief Mean absolute deviation of the non-NaN values from a known mean.
+     *
+     * The second pass of a report, after the mean came out of accumulate().
+     *
+     * @tparam Container Vector or ColumnView of a numeric type.
+     * @param data Values (NaN skipped).
+     * @param center Mean to measure the deviation from.
+     * @param scale Factor applied to each value first (like 3.6 for m/s to km/h).
+     * @return Mean absolute deviation, 0 if there are no valid values.
+     */
+template<typename Container>
+float meanAbsDeviation(const Container& data, float center, float scale = 1.0f) {
+    float mad = 0.0f;
+    int n = 0;
+    for(int i=0;i<data.GetSize();i++) {
+        if(!std::isnan(data[i])) { mad += std::abs(data[i]*scale - center); n++; }
+    }
+    return n > 0 ? mad/n : 0.0f;
+}
+
+
+    /**
+     * @brief Pearson correlation coefficient from a filled CoMomentAcc.
+     *
+     * Same rules as pearson(): rounded to two decimals, NaN with fewer than
+     * 2 pairs and 0 when one of the variables does not vary.
+     *
+     * @param acc Co-moments of the valid pairs.
+     * @return Correlation coefficient (rounded to 2 decimals), or NaN/0 for special cases.
+     * @throws std::invalid_argument if no pairs were added.
+     */
+inline float pearson(const CoMomentAcc& acc) {
+    if(acc.n == 0)
+        throw std::invalid_argument("No valid data pairs");
+    if(acc.n < 2) return NAN;
+    double denom = std::sqrt(acc.m2X * acc.m2Y);
+    return denom == 0 ? 0.0f : RoundVal(static_cast<float>(acc.coMoment / denom), 2);
+}
+
+
+    /**
+     * @brief mean() for a float column, using the SIMD sum kernel.
+     * @param data Column of values.
+     * @return The average, or NaN if no valid values.
+     */
+inline float mean(const ColumnView<float>& data) {
+    NanSums sums = nanSums(data.GetData(), data.GetSize());
+    return sums.count > 0 ? static_cast<float>(sums.sum / sums.count) : NAN;
+}
+
+
+    /**
+     * @brief stdev() for a float column, using the SIMD sum kernel.
+     * @param data Column of values.
+     * @return Standard deviation, or NaN if not enough data.
+     */
+inline float stdev(const ColumnView<float>& data) {
+    return static_cast<float>(MeanVarAcc::fromSums(nanSums(data.GetData(), data.GetSize())).getStdev());
+}
+
+
+    /**
+     * @brief pearson() for two float columns, using the SIMD cross-sum kernel.
+     * @param x First column.
+     * @param y Second column.
+     * @return Correlation coefficient (rounded to 2 decimals), or NaN/0 for special cases.
+     * @throws std::invalid_argument if column sizes don't match.
+     */
+inline float pearson(const ColumnView<float>& x, const ColumnView<float>& y) {
+    if(x.GetSize() != y.GetSize() || x.GetSize() == 0)
+        throw std::invalid_argument("Vector dimensions mismatch");
+    CrossSums sums = nanCrossSums(x.GetData(), y.GetData(), x.GetSize());
+    if(sums.count < 2) return NAN;
+    return pearson(CoMomentAcc::fromSums(sums));
+}
+
 #endif // STATISTICS_H
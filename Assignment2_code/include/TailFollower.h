@@ -0,0 +1,214 @@
+/**
+ * @file TailFollower.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.1
+ * @brief Follow mode: picks up the rows a station logger appends to the data files,
+ *        and files added to or removed from data/data_source.txt.
+ *
+ * The logger adds a row to the current CSV every 10 minutes. The files are
+ * loaded up to their last newline and the follower starts there. Every poll
+ * checks the file sizes and parses only the bytes added since, so new rows
+ * show up without loading anything again. Only complete lines are parsed; a
+ * line the logger is still writing is left for the next poll.
+ *
+ * Every poll also reads the file list again. A newly listed file is loaded
+ * (and followed from then on), and the rows of a file that is no longer
+ * listed are taken out, so yearly files can be rotated without a restart.
+ * A changed list is only used once two polls in a row read it the same,
+ * so a list that is caught halfway through being saved is not taken.
+ */
+
+#ifndef TAILFOLLOWER_H
+#define TAILFOLLOWER_H
+
+#include "FileHandler.h"
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "ParsePlan.h"
+#include "Vector.h"
+#include <string>
+
+/**
+* @struct FollowedFile
+* @brief A listed data file and how much of it has been read.
+**/
+struct FollowedFile {
+    std::string name; ///< File name as listed in data_source.txt
+    std::string path; ///< Path used to open the file
+    int id;           ///< Number its rows are marked with in the row runs
+    bool tail;        ///< Appended rows are read (false for compressed or unreadable files)
+    long long offset; ///< Bytes read so far (always whole lines), the next poll parses from here
+    ParsePlan plan;   ///< Decode steps built from the file's header
+
+    /**
+    * @brief Creates a file that has not been read.
+    */
+    FollowedFile() : id(-1), tail(false), offset(0) {}
+};
+
+/**
+* @struct RowRun
+* @brief Consecutive rows of a month log that came from one file.
+**/
+struct RowRun {
+    int file; ///< FollowedFile id, -1 if the file is not known
+    int rows; ///< Number of rows
+};
+
+/**
+* @struct FollowChanges
+* @brief What one poll changed.
+**/
+struct FollowChanges {
+    int added;   ///< Rows appended to files or loaded from newly listed files
+    int removed; ///< Rows of files no longer listed that were taken out
+
+    /**
+    * @brief Creates an empty change.
+    */
+    FollowChanges() : added(0), removed(0) {}
+
+    /**
+    * @brief Tells whether the poll changed the data.
+    * @return True if rows were added or removed.
+    */
+    bool any() const { return added > 0 || removed > 0; }
+};
+
+    /**
+     * @class TailFollower
+     * @brief Keeps the shared structures in step with the listed data files.
+     *
+     * New rows go after the existing ones of their month, and the month
+     * statistics and the range index take just the new rows instead of
+     * being built again (the range index is rebuilt if a new row is older
+     * than the latest loaded one). For every month the follower keeps which
+     * runs of rows came from which file, so a file's rows can be cut out
+     * again; the months it touched are put together without them before any
+     * of them replaces the old one, and their statistics are recomputed.
+     * Months left without rows are taken out of the BST.
+     *
+     * Changes are only made inside poll(), so a query never sees a file half
+     * added or half removed. A follower that was never opened does nothing,
+     * so code can poll it whether follow mode is on or not.
+     *
+     * Compressed files are loaded and removed like the others but not
+     * followed, a logger does not append to them. A file is loaded only up
+     * to its last newline and followed from exactly there, so a line the
+     * logger was writing during the load is read whole by a later poll. A
+     * file that gets shorter is no longer followed.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.1
+     * @date 16/10/26
+     */
+class TailFollower {
+public:
+        /**
+         * @brief Creates a follower that is not open (poll does nothing).
+         */
+    TailFollower();
+
+        /**
+         * @brief Starts following the files listed in data/data_source.txt from where they were loaded to.
+         *
+         * Call right after loading them with options.fileRows set, which tells
+         * the follower which rows each file added and where its load stopped
+         * (without it the loaded rows can not be taken out again, and files are
+         * followed from the end of their last complete line at this call). The
+         * structures are kept by reference and must outlive the follower.
+         *
+         * @param dateTree BST of the month keys.
+         * @param dataMap Table the rows are added to and removed from.
+         * @param index Per-month sums, kept up to date.
+         * @param ranges Time range sums, kept up to date.
+         * @param options Settings the files were loaded with (columns, threads, fileRows).
+         * @return False if the file list can not be read.
+         */
+    bool open(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap, MonthIndex& index, RangeIndex& ranges,
+              const LoadOptions& options);
+
+        /**
+         * @brief Tells whether open() succeeded.
+         * @return True if the files are followed.
+         */
+    bool IsOpen() const;
+
+        /**
+         * @brief Number of listed files whose appended rows are read.
+         * @return The count of followed files.
+         */
+    int GetFileCount() const;
+
+        /**
+         * @brief Applies the changes to the file list, then parses what was appended to the files.
+         *
+         * Costs reading the list and one size check per file when nothing
+         * changed. Each file loaded or removed is named on std::cerr.
+         *
+         * @return Rows added and removed.
+         */
+    FollowChanges poll();
+
+private:
+        /**
+         * @brief Loads newly listed files and removes the rows of files no longer listed.
+         * @param changes Receives the rows added and removed.
+         */
+    void reloadList(FollowChanges& changes);
+
+        /**
+         * @brief Cuts the rows of some files out of every month they are in.
+         * @param gone gone[id] is true for the files to remove.
+         * @return Number of rows removed.
+         */
+    int retract(const Vector<bool>& gone);
+
+        /**
+         * @brief Adds the rows one file gave to the structures and notes where they are.
+         * @param shard The new rows (moved out).
+         * @param file Id of the file they came from.
+         * @return Number of rows added.
+         */
+    int addShard(LoadShard& shard, int file);
+
+        /**
+         * @brief Notes that rows from a file were appended to a month.
+         * @param key Month key.
+         * @param file Id of the file.
+         * @param rows Number of rows.
+         */
+    void addRun(int key, int file, int rows);
+
+        /**
+         * @brief Notes a file's header and where following it starts.
+         * @param file The file (path set), its plan and offset are filled in here.
+         * @param fields Columns to load.
+         * @param offset Bytes already loaded, or -1 for up to the file's last newline now.
+         * @return False if the file can not be read, its header is not complete or lacks the core columns.
+         */
+    static bool start(FollowedFile& file, FieldSet fields, long long offset);
+
+        /**
+         * @brief Parses the complete lines appended to one file.
+         * @param file The file, its offset is moved past the parsed lines.
+         * @param shard Receives the new rows.
+         */
+    static void readAppended(FollowedFile& file, LoadShard& shard);
+
+    BST<int>* tree;                     ///< Month keys (not owned)
+    MonthTable<WeatherLog>* data;       ///< Loaded rows (not owned)
+    MonthIndex* monthIndex;             ///< Per-month sums (not owned)
+    RangeIndex* rangeIndex;             ///< Time range sums (not owned)
+    FieldSet fields;                    ///< Columns to load from new files
+    int threads;                        ///< Threads for parsing a newly listed file
+    Vector<FollowedFile> files;         ///< Listed files in the order they were loaded
+    Vector<std::string> listed;         ///< File list the files match
+    Vector<std::string> seen;           ///< File list read by the last poll
+    MonthTable<Vector<RowRun> > runs;   ///< Which file each month's rows came from, in row order
+    int nextId;                         ///< Id for the next file loaded
+    bool rangesStale;                   ///< The range index has to be built again
+};
+
+#endif // TAILFOLLOWER_H
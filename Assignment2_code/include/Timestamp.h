@@ -0,0 +1,121 @@
+/**
+ * @file Timestamp.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.1
+ * @brief Conversion between Date/MyTime and minutes since 1 Jan 1970 00:00.
+ *
+ * A reading's time as a single int makes it easy to sort, compare and
+ * binary search, and is how WeatherLog stores it. The readings have no time
+ * zone, so these are plain calendar minutes (no daylight saving). An int holds
+ * about 4000 years of minutes either side of 1970, so stored years are limited
+ * to MIN_STAMP_YEAR..MAX_STAMP_YEAR.
+ */
+
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include "Date.h"
+#include "MyTime.h"
+
+const int MIN_STAMP_YEAR = 1;    ///< Earliest year a reading can have
+const int MAX_STAMP_YEAR = 6000; ///< Latest year a reading can have
+
+    /**
+     * @brief Number of days in a month (leap years included).
+     * @param year Year.
+     * @param month Month (1-12).
+     * @return 28 to 31.
+     */
+inline int daysInMonth(int year, int month) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) return 29;
+    return days[month - 1];
+}
+
+    /**
+     * @brief Checks that a calendar date exists and fits the epoch minute range.
+     * @param year Year.
+     * @param month Month.
+     * @param day Day of the month.
+     * @return True if the date can be stored as epoch minutes.
+     */
+inline bool isStampDate(int year, int month, int day) {
+    return year >= MIN_STAMP_YEAR && year <= MAX_STAMP_YEAR && month >= 1 && month <= 12 &&
+           day >= 1 && day <= daysInMonth(year, month);
+}
+
+    /**
+     * @brief Days from 1 Jan 1970 to a calendar date (proleptic Gregorian).
+     * @param year Year.
+     * @param month Month (1-12).
+     * @param day Day of the month (1-31).
+     * @return Day number, negative before 1970.
+     */
+inline int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+    /**
+     * @brief Calendar date of a day number (inverse of daysFromCivil).
+     * @param days Days since 1 Jan 1970.
+     * @param year Receives the year.
+     * @param month Receives the month (1-12).
+     * @param day Receives the day of the month.
+     */
+inline void civilFromDays(int days, int& year, int& month, int& day) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+    /**
+     * @brief Day number of a time (rounds down, so times before 1970 work too).
+     * @param minutes Minutes since 1 Jan 1970 00:00.
+     * @return Days since 1 Jan 1970.
+     */
+inline int dayOfMinutes(int minutes) {
+    return minutes >= 0 ? minutes / 1440 : -((-minutes + 1439) / 1440);
+}
+
+    /**
+     * @brief Minutes since 1 Jan 1970 00:00 of a reading's date and time.
+     * @param date Date of the reading.
+     * @param time Time of the reading.
+     * @return Epoch minutes.
+     */
+inline int toEpochMinutes(const Date& date, const MyTime& time) {
+    return daysFromCivil(date.GetYear(), date.GetMonth(), date.GetDay()) * 1440
+           + time.GetHour() * 60 + time.GetMinute();
+}
+
+    /**
+     * @brief Splits epoch minutes back into a Date and MyTime.
+     * @param minutes Minutes since 1 Jan 1970 00:00.
+     * @param date Receives the date.
+     * @param time Receives the time.
+     */
+inline void fromEpochMinutes(int minutes, Date& date, MyTime& time) {
+    int days = dayOfMinutes(minutes);
+    int inDay = minutes - days * 1440;
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    date.SetYear(year);
+    date.SetMonth(month);
+    date.SetDay(day);
+    time.SetHour(inDay / 60);
+    time.SetMinute(inDay % 60);
+}
+
+#endif // TIMESTAMP_H
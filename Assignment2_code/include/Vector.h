@@ -3,57 +3,83 @@
  * @author Svetlana Alkhasova
  * @date 18/07/25
  *
- * @version 2.0
+ * @version 3.0
  * @brief Templated dynamic array with auto growing and simple operations, minimal and completed
  */
 
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
 
     /**
      * @class Vector
      * @author Svetlana Alkhasova
      * @date 18/07/25
-     * @version 2.0
+     * @version 3.0
      * @brief An expandable array that handles memory and lets you store any type.
      *
      * This is a basic custom vector class  it can grow if you add more items,
      * and lets you safely get/set values with []. Good for assignments where you
      * cant use the STL vector by itself.
      *
+     * Memory comes from the allocator and only the first GetSize() slots hold
+     * constructed items, so T does not need a default constructor. Nothing is
+     * allocated until the first item (or a reserve), and growing moves the items
+     * instead of copying them. Returning a Vector from a function moves it.
+     *
      * @tparam T The type of things you want to store (like int, float, WeatherEntry, ...)
+     * @tparam Alloc Allocator for the storage (std::allocator by default).
      */
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T> >
 class Vector {
 public:
+    typedef T* iterator;             ///< Iterators are plain pointers into the storage
+    typedef const T* const_iterator; ///< Read-only iterator
+
         /**
          * @brief Creates an empty vector with space for at least n items.
-         * @param n Initial capacity (defaults to 1 if not set or given <1)
+         * @param n Initial capacity (nothing is allocated if not set or given <1)
+         * @param alloc Allocator to get the storage from.
          */
-    Vector(int n = 1);
+    Vector(int n = 0, const Alloc& alloc = Alloc());
 
         /**
          * @brief Makes a vector with n copies of a given value.
          * @param n Number of elements to start with.
          * @param defaultValue The value to fill the vector with.
+         * @param alloc Allocator to get the storage from.
          */
-    Vector(int n, const T& defaultValue);
+    Vector(int n, const T& defaultValue, const Alloc& alloc = Alloc());
 
         /**
          * @brief Copy constructor  makes a new vector as a full copy of another.
          * @param other The vector to copy from.
          */
-    Vector(const Vector<T>& other);
+    Vector(const Vector& other);
+
+        /**
+         * @brief Move constructor, takes over the other vector's storage (other is left empty).
+         * @param other The vector to move from.
+         */
+    Vector(Vector&& other) noexcept;
 
         /**
          * @brief Assignment operator  replaces what's inside with another vector's stuff.
          * @param other The vector to copy from.
          * @return Reference to this vector after copying.
          */
-    Vector<T>& operator=(const Vector<T>& other);
+    Vector& operator=(const Vector& other);
+
+        /**
+         * @brief Move assignment, frees this vector's items and takes over the other's storage.
+         * @param other The vector to move from (left empty).
+         * @return Reference to this vector.
+         */
+    Vector& operator=(Vector&& other) noexcept;
 
         /**
          * @brief Destructor, cleans up any memory used by the vector.
@@ -67,6 +93,20 @@ public:
          */
     void pushBack(const T& element);
 
+        /**
+         * @brief Adds a new item to the end by moving it in.
+         * @param element Value to move to the end.
+         */
+    void pushBack(T&& element);
+
+        /**
+         * @brief Builds a new item in place at the end from constructor arguments.
+         * @param args Arguments for T's constructor.
+         * @return Reference to the new item.
+         */
+    template <typename... Args>
+    T& emplaceBack(Args&&... args);
+
         /**
          * @brief Removes one item from the end (if the vector isnt empty).
          */
@@ -83,6 +123,18 @@ public:
          */
     int GetSize() const;
 
+        /**
+         * @brief How many items fit before the storage has to grow.
+         * @return The reserved capacity.
+         */
+    int GetCapacity() const;
+
+        /**
+         * @brief Makes room for at least n items, so that many pushBacks don't reallocate.
+         * @param n Wanted capacity (smaller values do nothing).
+         */
+    void reserve(int n);
+
         /**
          * @brief Doubles the vector's capacity when there isn't enough space.
          *
@@ -91,6 +143,43 @@ public:
          */
     void resize();
 
+        /**
+         * @brief Pointer to the first item, for loops that don't need range checks.
+         * @return Start of the items (NULL if nothing was ever allocated).
+         */
+    T* GetData();
+
+        /**
+         * @brief Same as above, but for read-only (const) access.
+         */
+    const T* GetData() const;
+
+        /**
+         * @brief Iterator to the first item.
+         */
+    iterator begin() { return data; }
+
+        /**
+         * @brief Iterator just past the last item.
+         */
+    iterator end() { return data + size; }
+
+        /**
+         * @brief Read-only iterator to the first item.
+         */
+    const_iterator begin() const { return data; }
+
+        /**
+         * @brief Read-only iterator just past the last item.
+         */
+    const_iterator end() const { return data + size; }
+
+        /**
+         * @brief Copy of the allocator the vector uses.
+         * @return The allocator.
+         */
+    Alloc GetAllocator() const;
+
         /**
          * @brief Lets you use square-brackets to get/set items by index.
          * @param index Which element to access (starts at 0)
@@ -105,6 +194,14 @@ public:
     const T& operator[](int index) const;
 
 private:
+    typedef std::allocator_traits<Alloc> Traits;
+
+    //moves the items into new storage of the given capacity
+    void reallocate(int newCapacity);
+    //destroys the items and gives the storage back
+    void release();
+
+    Alloc alloc; ///< Where the storage comes from
     T* data; ///< Points to the array storing the items
     int size; ///< How many elements are currently in use
     int capacity;///< How much space has been allocated (can be bigger than size)
@@ -112,82 +209,171 @@ private:
 
 //IMPLEMENTATION
 
-template <typename T>
-Vector<T>::Vector(int n) : size(0), capacity(n > 0 ? n : 1) {
-    data = new T[capacity];
+template <typename T, typename Alloc>
+Vector<T, Alloc>::Vector(int n, const Alloc& a) : alloc(a), data(NULL), size(0), capacity(0) {
+    if (n > 0) reserve(n);
+}
+
+template <typename T, typename Alloc>
+Vector<T, Alloc>::Vector(int n, const T& defaultValue, const Alloc& a) : alloc(a), data(NULL), size(0), capacity(0) {
+    if (n <= 0) return;
+    reserve(n);
+    for (int i = 0; i < n; i++) emplaceBack(defaultValue);
 }
 
-template <typename T>
-Vector<T>::Vector(int n, const T& defaultValue) : size(n), capacity(n > 0 ? n : 1) {
-    data = new T[capacity];
-    for (int i = 0; i < size; i++) data[i] = defaultValue;
+template <typename T, typename Alloc>
+Vector<T, Alloc>::Vector(const Vector& other)
+    : alloc(Traits::select_on_container_copy_construction(other.alloc)), data(NULL), size(0), capacity(0) {
+    reserve(other.size);
+    for (int i = 0; i < other.size; i++) emplaceBack(other.data[i]);
 }
 
-template <typename T>
-Vector<T>::Vector(const Vector<T>& other) : size(other.size), capacity(other.capacity) {
-    data = new T[capacity];
-    for (int i = 0; i < size; i++) data[i] = other.data[i];
+template <typename T, typename Alloc>
+Vector<T, Alloc>::Vector(Vector&& other) noexcept
+    : alloc(std::move(other.alloc)), data(other.data), size(other.size), capacity(other.capacity) {
+    other.data = NULL;
+    other.size = 0;
+    other.capacity = 0;
 }
 
-template <typename T>
-Vector<T>& Vector<T>::operator=(const Vector<T>& other) {
+template <typename T, typename Alloc>
+Vector<T, Alloc>& Vector<T, Alloc>::operator=(const Vector& other) {
     if (this != &other) {
-        delete[] data;
+        Vector copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename T, typename Alloc>
+Vector<T, Alloc>& Vector<T, Alloc>::operator=(Vector&& other) noexcept {
+    if (this != &other) {
+        release();
+        alloc = std::move(other.alloc);
+        data = other.data;
         size = other.size;
         capacity = other.capacity;
-        data = new T[capacity];
-        for (int i = 0; i < size; i++) data[i] = other.data[i];
+        other.data = NULL;
+        other.size = 0;
+        other.capacity = 0;
     }
     return *this;
 }
 
-template <typename T>
-Vector<T>::~Vector() {
-    delete[] data;
+template <typename T, typename Alloc>
+Vector<T, Alloc>::~Vector() {
+    release();
+}
+
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::release() {
+    Clear();
+    if (data) Traits::deallocate(alloc, data, capacity);
     data = NULL;
-    size = 0;
     capacity = 0;
 }
 
-template <typename T>
-void Vector<T>::resize() {
-    int newCapacity = capacity * 2;
-    T* tmp = new T[newCapacity];
-    for (int i = 0; i < size; i++) tmp[i] = data[i];
-    delete[] data;
-    data = tmp;
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::reallocate(int newCapacity) {
+    T* fresh = Traits::allocate(alloc, newCapacity);
+    for (int i = 0; i < size; i++) {
+        Traits::construct(alloc, fresh + i, std::move_if_noexcept(data[i]));
+        Traits::destroy(alloc, data + i);
+    }
+    if (data) Traits::deallocate(alloc, data, capacity);
+    data = fresh;
     capacity = newCapacity;
 }
 
-template <typename T>
-void Vector<T>::pushBack(const T& element) {
-    if (size == capacity) resize();
-    data[size++] = element;
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::reserve(int n) {
+    if (n > capacity) reallocate(n);
 }
 
-template <typename T>
-void Vector<T>::popBack() {
-    if (size > 0) size--;
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::resize() {
+    reallocate(capacity > 0 ? capacity * 2 : 4);
 }
 
-template <typename T>
-void Vector<T>::Clear() {
-    size = 0;
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::pushBack(const T& element) {
+    emplaceBack(element);
 }
 
-template <typename T>
-int Vector<T>::GetSize() const {
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::pushBack(T&& element) {
+    emplaceBack(std::move(element));
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+T& Vector<T, Alloc>::emplaceBack(Args&&... args) {
+    if (size == capacity) {
+        //build the new item before the old storage goes, args may point into it
+        int newCapacity = capacity > 0 ? capacity * 2 : 4;
+        T* fresh = Traits::allocate(alloc, newCapacity);
+        try {
+            Traits::construct(alloc, fresh + size, std::forward<Args>(args)...);
+        } catch (...) {
+            Traits::deallocate(alloc, fresh, newCapacity);
+            throw;
+        }
+        for (int i = 0; i < size; i++) {
+            Traits::construct(alloc, fresh + i, std::move_if_noexcept(data[i]));
+            Traits::destroy(alloc, data + i);
+        }
+        if (data) Traits::deallocate(alloc, data, capacity);
+        data = fresh;
+        capacity = newCapacity;
+    } else {
+        Traits::construct(alloc, data + size, std::forward<Args>(args)...);
+    }
+    return data[size++];
+}
+
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::popBack() {
+    if (size > 0) Traits::destroy(alloc, data + --size);
+}
+
+template <typename T, typename Alloc>
+void Vector<T, Alloc>::Clear() {
+    while (size > 0) Traits::destroy(alloc, data + --size);
+}
+
+template <typename T, typename Alloc>
+int Vector<T, Alloc>::GetSize() const {
     return size;
 }
 
-template <typename T>
-T& Vector<T>::operator[](int index) {
+template <typename T, typename Alloc>
+int Vector<T, Alloc>::GetCapacity() const {
+    return capacity;
+}
+
+template <typename T, typename Alloc>
+T* Vector<T, Alloc>::GetData() {
+    return data;
+}
+
+template <typename T, typename Alloc>
+const T* Vector<T, Alloc>::GetData() const {
+    return data;
+}
+
+template <typename T, typename Alloc>
+Alloc Vector<T, Alloc>::GetAllocator() const {
+    return alloc;
+}
+
+template <typename T, typename Alloc>
+T& Vector<T, Alloc>::operator[](int index) {
     if (index < 0 || index >= size) throw std::out_of_range("Index out of range");
     return data[index];
 }
 
-template <typename T>
-const T& Vector<T>::operator[](int index) const {
+template <typename T, typename Alloc>
+const T& Vector<T, Alloc>::operator[](int index) const {
     if (index < 0 || index >= size) throw std::out_of_range("Index out of range");
     return data[index];
 }
@@ -2,11 +2,11 @@
  * @file WeatherEntry.h
  * @author Svetlana Alkhasova
  * @date 18/07/25
- * @version 3.0
- * @brief A single weather measurement and a type alias for logs of weather data.
+ * @version 5.0
+ * @brief A single weather measurement.
  *
- * This file sets up a struct for one line of weather readings (date, time, wind, temperature, solar)
- * and gives a shortcut for making a list of these with Vector class.
+ * This file sets up a struct for one line of weather readings (date and time, wind, temperature, solar).
+ * Lists of these are stored column by column in WeatherLog (see WeatherLog.h).
  */
 
 #ifndef WEATHERENTRY_H
@@ -15,31 +15,59 @@
 
 #include "Date.h"
 #include "MyTime.h"
-#include "Vector.h"
+#include "Timestamp.h"
 
 /**
 * @struct WeatherEntry
 * @brief Holds one record of weather readings (from a single moment in time).
 *
-* This struct is just one set of data: date, time, wind speed, temperature, and solar power.
+* This struct is just one set of data: date and time, wind speed, temperature, and solar power.
 * All together, its one "row" from a weather csv
 *
+* The date and time are packed into one int of minutes since 1 Jan 1970 (see
+* Timestamp.h), so a record is 16 bytes and times compare and subtract directly.
+* GetDate, GetTime and SetDateTime convert to and from Date and MyTime.
+*
 **/
 struct WeatherEntry {
-    Date date;    ///< Date for the measurement
-    MyTime time;///< Time of the measurement
+    int minutes;       ///< Date and time of the measurement, in epoch minutes
     float windSpeed;  ///< Wind speed (km/h)
     float temperature; ///< Temperature  C
     float solarRadiation;///< Solar radiation (W/m^2)
+
+    /**
+     * @brief Date of the measurement.
+     * @return The date part of minutes.
+     */
+    Date GetDate() const {
+        Date date;
+        MyTime time;
+        fromEpochMinutes(minutes, date, time);
+        return date;
+    }
+
+    /**
+     * @brief Time of day of the measurement.
+     * @return The time part of minutes.
+     */
+    MyTime GetTime() const {
+        int inDay = minutes - dayOfMinutes(minutes) * 1440;
+        MyTime time;
+        time.SetHour(inDay / 60);
+        time.SetMinute(inDay % 60);
+        return time;
+    }
+
+    /**
+     * @brief Sets minutes from a date and a time of day.
+     * @param date Date of the measurement.
+     * @param time Time of the measurement.
+     */
+    void SetDateTime(const Date& date, const MyTime& time) {
+        minutes = toEpochMinutes(date, time);
+    }
 };
 
-/**
-* @typedef WeatherLog
-* @brief A vector of WeatherEntry records, used for storing lots of readings together.
-*
-* Makes it easier to talk about a full group of entries from a single month or year.
-*
-**/
-typedef Vector<WeatherEntry> WeatherLog;
+static_assert(sizeof(WeatherEntry) == 16, "WeatherEntry should pack into 16 bytes");
 
 #endif // WEATHERENTRY_H
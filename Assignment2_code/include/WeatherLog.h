@@ -0,0 +1,189 @@
+/**
+ * @file WeatherLog.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.4
+ * @brief Column-wise storage for a list of weather readings.
+ *
+ * A WeatherLog keeps one contiguous array per field instead of an array of
+ * WeatherEntry structs, so a statistic over one variable only reads that variable.
+ * Besides the WeatherEntry columns a log can hold extra measurement columns
+ * (RH, QFE, ...) when the loader was asked for them (see MetFields.h).
+ *
+ * The columns are reference counted: copying a log shares them, and a log
+ * whose columns are shared copies them only when it is changed. So the
+ * versions follow mode publishes (see SnapshotStore.h) share every month
+ * a poll did not touch, and the shared columns are never written again.
+ */
+
+#ifndef WEATHERLOG_H
+#define WEATHERLOG_H
+
+#include "WeatherEntry.h"
+#include "ColumnView.h"
+#include "MetFields.h"
+#include "Vector.h"
+#include <memory>
+
+    /**
+     * @class WeatherLog
+     * @brief A list of weather readings stored as separate columns (struct of arrays).
+     *
+     * Rows are added and read back as WeatherEntry values, columns can be read
+     * without copying through ColumnView. Used for storing all the readings of
+     * a single month (or a whole file while loading).
+     *
+     * Copies can be made, read and dropped on any thread; like any value, one
+     * copy is only changed by one thread at a time. Views taken from a log
+     * stay valid while its columns are not changed (a change of a shared log
+     * leaves the views on the old columns).
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.1
+     * @date 16/10/26
+     */
+class WeatherLog {
+public:
+        /**
+         * @brief Creates an empty log.
+         */
+    WeatherLog();
+
+        /**
+         * @brief Adds one reading to the end of every column.
+         * @param entry Reading to add.
+         */
+    void pushBack(const WeatherEntry& entry);
+
+        /**
+         * @brief Adds one reading together with values for extra columns.
+         *
+         * Columns that are new to the log start with NaN for the rows already
+         * in it, extra columns the log has but fields leaves out get NaN.
+         *
+         * @param entry Reading to add.
+         * @param values Extra values indexed by MetField (only the fields ones are read).
+         * @param fields Extra fields the values are given for.
+         */
+    void pushBack(const WeatherEntry& entry, const float* values, FieldSet fields);
+
+        /**
+         * @brief Makes room for at least rows readings in every column.
+         * @param rows Wanted number of rows.
+         */
+    void reserve(int rows);
+
+        /**
+         * @brief Adds all readings of another log after the existing ones.
+         *
+         * Extra columns only one of the two logs has are filled with NaN.
+         *
+         * @param other Log to copy the rows from.
+         */
+    void append(const WeatherLog& other);
+
+        /**
+         * @brief Adds some consecutive readings of another log after the existing ones.
+         * @param other Log to copy the rows from.
+         * @param first First row to copy.
+         * @param count Number of rows to copy.
+         */
+    void append(const WeatherLog& other, int first, int count);
+
+        /**
+         * @brief Removes all readings (keeps the reserved space, unless the columns are shared).
+         */
+    void Clear();
+
+        /**
+         * @brief Number of readings in the log.
+         * @return The count of rows.
+         */
+    int GetSize() const;
+
+        /**
+         * @brief Puts one row back together from the columns.
+         * @param index Row to read (starts at 0).
+         * @return Copy of the reading.
+         * @throws std::out_of_range if index is wrong.
+         */
+    WeatherEntry operator[](int index) const;
+
+        /**
+         * @brief Timestamp column.
+         * @return View of the reading times in epoch minutes (see Timestamp.h), one per row.
+         */
+    ColumnView<int> GetTimestamps() const;
+
+        /**
+         * @brief Wind speed column.
+         * @return View of the wind speeds (NaN where missing).
+         */
+    ColumnView<float> GetWindSpeeds() const;
+
+        /**
+         * @brief Temperature column.
+         * @return View of the temperatures (NaN where missing).
+         */
+    ColumnView<float> GetTemperatures() const;
+
+        /**
+         * @brief Solar radiation column.
+         * @return View of the solar radiation readings (NaN where missing).
+         */
+    ColumnView<float> GetSolarRadiation() const;
+
+        /**
+         * @brief Extra columns held by the log.
+         * @return Set of the fields besides WeatherEntry's that have a column.
+         */
+    FieldSet GetExtraFields() const;
+
+        /**
+         * @brief Any measurement column by field.
+         * @param field A MetField: S, T, SR, or an extra field.
+         * @return View of the column, empty for WAST or an extra field the log does not hold.
+         */
+    ColumnView<float> GetColumn(int field) const;
+
+private:
+    /**
+    * @struct Columns
+    * @brief The readings of a log, shared by its copies.
+    **/
+    struct Columns {
+        Vector<int> stamps;    ///< Date and time of each reading in epoch minutes
+        Vector<float> wind;    ///< Wind speed of each reading
+        Vector<float> temp;    ///< Temperature of each reading
+        Vector<float> solar;   ///< Solar radiation of each reading
+        FieldSet extraFields;  ///< Fields that have a column in extras
+        Vector<float> extras[FIELD_COUNT]; ///< Extra columns by MetField, only extraFields ones are used
+
+        /**
+        * @brief Creates empty columns.
+        */
+        Columns() : extraFields(0) {}
+    };
+
+        /**
+         * @brief The columns to change, copied first if another log shares them.
+         * @return Columns only this log holds.
+         */
+    Columns& edit();
+
+        /**
+         * @brief The columns to read.
+         * @return The log's columns, or empty ones if it has none yet.
+         */
+    const Columns& read() const;
+
+        /**
+         * @brief Adds the given extra columns that are missing, NaN for every existing row.
+         * @param fields Extra fields wanted.
+         */
+    void addExtraColumns(FieldSet fields);
+
+    std::shared_ptr<Columns> columns; ///< The readings (NULL while empty), shared by copies until one changes
+};
+
+#endif // WEATHERLOG_H
@@ -0,0 +1,117 @@
+/**
+ * @file WeatherLogView.h
+ * @author Svetlana Alkhasova
+ * @date 16/10/26
+ * @version 1.1
+ * @brief Read-only, non-owning view of some or all rows of a WeatherLog.
+ */
+
+#ifndef WEATHERLOGVIEW_H
+#define WEATHERLOGVIEW_H
+
+#include "WeatherLog.h"
+#include "ColumnView.h"
+#include <stdexcept>
+
+    /**
+     * @class WeatherLogView
+     * @brief A WeatherLog pointer plus a row range, returned by the DataUtils queries.
+     *
+     * Making or copying a view never copies rows or allocates. Like ColumnView it is
+     * only valid while the WeatherLog it points into is alive and not changed in size.
+     * A WeatherLog converts to a view of all its rows, so functions taking a view
+     * also take a log. A temporary WeatherLog does not: its view would point at
+     * freed rows once the expression ends, so those constructors are deleted.
+     *
+     * @author Svetlana Alkhasova
+     * @version 1.1
+     * @date 16/10/26
+     */
+class WeatherLogView {
+public:
+        /**
+         * @brief Creates an empty view.
+         */
+    WeatherLogView() : log(NULL), first(0), size(0) {}
+
+        /**
+         * @brief Creates a view of all rows of a log.
+         * @param log Log to look at.
+         */
+    WeatherLogView(const WeatherLog& log) : log(&log), first(0), size(log.GetSize()) {}
+
+        /**
+         * @brief Not allowed: the view would outlive the temporary log.
+         */
+    WeatherLogView(WeatherLog&&) = delete;
+
+        /**
+         * @brief Creates a view of rows [first, first + count) of a log.
+         * @param log Log to look at.
+         * @param first First row of the view.
+         * @param count Number of rows.
+         * @throws std::out_of_range if the rows are not all in the log.
+         */
+    WeatherLogView(const WeatherLog& log, int first, int count) : log(&log), first(first), size(count) {
+        if (first < 0 || count < 0 || first + count > log.GetSize()) throw std::out_of_range("Row range out of range");
+    }
+
+        /**
+         * @brief Not allowed: the view would outlive the temporary log.
+         */
+    WeatherLogView(WeatherLog&&, int, int) = delete;
+
+        /**
+         * @brief Number of rows in the view.
+         * @return The count of rows.
+         */
+    int GetSize() const { return size; }
+
+        /**
+         * @brief Puts one row back together from the columns.
+         * @param index Row of the view to read (starts at 0).
+         * @return Copy of the reading.
+         * @throws std::out_of_range if index is wrong.
+         */
+    WeatherEntry operator[](int index) const {
+        if (index < 0 || index >= size) throw std::out_of_range("Index out of range");
+        return (*log)[first + index];
+    }
+
+        /**
+         * @brief Timestamp column of the viewed rows.
+         * @return View of the reading times in epoch minutes.
+         */
+    ColumnView<int> GetTimestamps() const { return log ? slice(log->GetTimestamps()) : ColumnView<int>(); }
+
+        /**
+         * @brief Wind speed column of the viewed rows.
+         * @return View of the wind speeds (NaN where missing).
+         */
+    ColumnView<float> GetWindSpeeds() const { return log ? slice(log->GetWindSpeeds()) : ColumnView<float>(); }
+
+        /**
+         * @brief Temperature column of the viewed rows.
+         * @return View of the temperatures (NaN where missing).
+         */
+    ColumnView<float> GetTemperatures() const { return log ? slice(log->GetTemperatures()) : ColumnView<float>(); }
+
+        /**
+         * @brief Solar radiation column of the viewed rows.
+         * @return View of the solar radiation readings (NaN where missing).
+         */
+    ColumnView<float> GetSolarRadiation() const { return log ? slice(log->GetSolarRadiation()) : ColumnView<float>(); }
+
+private:
+    //the part of a whole-log column this view covers
+    template <typename T>
+    ColumnView<T> slice(const ColumnView<T>& column) const {
+        return size > 0 ? ColumnView<T>(column.GetData() + first, size) : ColumnView<T>();
+    }
+
+    const WeatherLog* log; ///< Log the rows are in (NULL for an empty view)
+    int first;             ///< First row of the view
+    int size;              ///< Number of rows
+};
+
+#endif // WEATHERLOGVIEW_H
@@ -1,19 +1,203 @@
 #include "Menu.h"
 #include "FileHandler.h"
-#include "WeatherEntry.h"
+#include "MonthIndex.h"
+#include "RangeIndex.h"
+#include "LazyLoader.h"
+#include "BatchRunner.h"
+#include "ReportEngine.h"
+#include "TailFollower.h"
+#include "SnapshotStore.h"
+#include "WeatherLog.h"
 #include "BST.h"
+#include "MonthTable.h"
 #include "Vector.h"
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include <string>
+#include <functional>
+#include <thread>
+#include <climits>
 
-int main() {
-    BST<std::string> dateTree; //stores unique year/month keys
-    std::map<std::string, WeatherLog> dataMap;
+//reads a whole non-negative decimal number, returns false for anything else (empty, letters, sign, overflow)
+static bool parseCount(const char* text, int& value) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = NULL;
+    long parsed = std::strtol(text, &end, 10);
+    if (*end != '\0' || parsed > INT_MAX) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+//reads command line options, returns false on an unknown or incomplete option or a script that can not be read.
+//batch queries from --batch scripts and --query are collected in the order given
+static bool parseOptions(int argc, char* argv[], LoadOptions& options, Vector<std::string>& queries, bool& batch,
+                         ReportOptions& report, bool& reportRequested, int& followSeconds) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            //0 means one thread per core, so a typo must not quietly turn into it
+            if (!parseCount(argv[++i], options.threads)) return false;
+        } else if (std::strcmp(argv[i], "--no-cache") == 0) {
+            options.useCache = false;
+        } else if (std::strcmp(argv[i], "--fields") == 0 && i + 1 < argc) {
+            if (!parseFieldList(argv[++i], options.fields)) return false;
+        } else if (std::strcmp(argv[i], "--lazy") == 0) {
+            options.lazy = true;
+        } else if (std::strcmp(argv[i], "--pipeline") == 0) {
+            options.pipeline = true;
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = true;
+            if (!BatchRunner::readScript(argv[++i], queries)) {
+                std::cerr << "Could not open query script: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(argv[i], "--query") == 0 && i + 1 < argc) {
+            batch = true;
+            queries.pushBack(argv[++i]);
+        } else if (std::strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            reportRequested = true;
+            if (!ReportEngine::parseYears(argv[++i], report)) return false;
+        } else if (std::strcmp(argv[i], "--report-file") == 0 && i + 1 < argc) {
+            report.filename = argv[++i];
+        } else if (std::strcmp(argv[i], "--per-year") == 0) {
+            report.perYear = true;
+        } else if (std::strcmp(argv[i], "--follow") == 0 && i + 1 < argc) {
+            if (!parseCount(argv[++i], followSeconds) || followSeconds < 1) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+//writes the --report files and runs the batch queries on one version of the data, returns the exit status
+static int runQueries(const DataSnapshot& data, LazyLoader& lazy, const Vector<std::string>& queries, bool batch,
+                      ReportOptions& report, bool reportRequested, int threads) {
+    int status = 0;
+    if (reportRequested) {
+        //months are worked out on the --threads count, then each file is written in one go
+        report.threads = threads;
+        if (!ReportEngine::write(data.dateTree, data.dataMap, data.monthIndex, lazy, report)) status = 1;
+    }
+    if (batch) {
+        //results on standard output, one load for all the queries
+        int invalid = BatchRunner::run(queries, data.dataMap, data.monthIndex, data.rangeIndex, lazy,
+                                       threads, std::cout);
+        if (invalid > 0) status = 1;
+    }
+    return status;
+}
+
+//a copy of the working data that the follower can no longer change; it shares the month logs and
+//range index chunks, the follower copies the ones it changes next
+static DataSnapshot* copyOf(const DataSnapshot& working) {
+    DataSnapshot* copy = new DataSnapshot(working);
+    copy->readings = 0;
+    copy->dataMap.forEach([copy](int, const WeatherLog& log) { copy->readings += log.GetSize(); });
+    return copy;
+}
 
-    if (!FileHandler::loadDataFiles(dateTree, dataMap)) {
-        return 1; //exit if no data loaded
+//the ingesting thread: polls the follower every few seconds and publishes each change, until stop is set
+static void ingest(TailFollower& follower, const DataSnapshot& working, SnapshotStore& store, int seconds,
+                   const std::atomic<bool>& stop) {
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (!stop.load()) {
+        //short naps, so stopping does not wait for a whole period
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() < next) continue;
+        next = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        if (follower.poll().any()) store.publish(copyOf(working));
+        else store.reclaim();
     }
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    Vector<std::string> queries;
+    bool batch = false;
+    ReportOptions report;
+    bool reportRequested = false;
+    int followSeconds = 0;
+    //a lazily loaded file is only indexed as far as it went at startup, so it can not be followed
+    if (!parseOptions(argc, argv, options, queries, batch, report, reportRequested, followSeconds) ||
+        (followSeconds > 0 && options.lazy)) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--no-cache] [--fields LIST] [--lazy] [--pipeline]"
+                  << " [--batch FILE] [--query Q] [--report YEARS] [--report-file NAME] [--per-year]"
+                  << " [--follow SECONDS]" << std::endl;
+        std::cerr << "  --threads N    load data files on N threads (0 = one per core, default 1)" << std::endl;
+        std::cerr << "  --no-cache     always parse the CSV files, do not read or write data/weather.cache" << std::endl;
+        std::cerr << "  --fields LIST  also load these columns, like RH,QFE or all (WAST, S, T and SR are always loaded)" << std::endl;
+        std::cerr << "  --lazy         only index the files at startup, parse each month when a query first needs it" << std::endl;
+        std::cerr << "  --pipeline     parse each file with a reader, parser and indexer stage, and print their wait counts" << std::endl;
+        std::cerr << "  --batch FILE   run the queries in FILE (- for standard input) instead of the menu" << std::endl;
+        std::cerr << "  --query Q      run query Q instead of the menu, like \"wind 2007 6\" (can be repeated)" << std::endl;
+        std::cerr << "  --report YEARS write the WindTempSolar statistics of all, one (2007) or a range (2007-2010) of years" << std::endl;
+        std::cerr << "  --report-file NAME  file for --report (default WindTempSolar.csv)" << std::endl;
+        std::cerr << "  --per-year     write one file per year, like WindTempSolar_2007.csv, instead of one combined file" << std::endl;
+        std::cerr << "  --follow SECONDS  pick up rows appended to the data files and files added to or removed from" << std::endl;
+        std::cerr << "                 data_source.txt (not with --lazy); batch queries and reports run again when" << std::endl;
+        std::cerr << "                 the data changed, checked every SECONDS" << std::endl;
+        return 1;
+    }
+
+    DataSnapshot data; //the loaded data; in follow mode only the ingesting thread touches it once it runs
+    BST<int>& dateTree = data.dateTree; //stores unique month keys (year*12 + month-1)
+    MonthTable<WeatherLog>& dataMap = data.dataMap; //records by month key
+    MonthIndex& monthIndex = data.monthIndex; //per-month sums for the menu statistics
+    RangeIndex& rangeIndex = data.rangeIndex; //time-sorted running sums for time range statistics
+    LazyLoader lazy; //only opened with --lazy, then it fills the structures above on demand
+    TailFollower follower; //only opened with --follow, then it keeps the structures in step with the data files
 
-    Menu::run(dateTree, dataMap);
+    if (options.lazy) {
+        if (!lazy.open(dateTree, dataMap, monthIndex, rangeIndex, options)) {
+            return 1; //exit if no file could be indexed
+        }
+    } else {
+        PipelineStats pipelineStats;
+        Vector<FileRows> fileRows;
+        //the follower needs to know which rows each file gave, to take them out if the file is unlisted
+        if (followSeconds > 0) options.fileRows = &fileRows;
+        if (options.pipeline) options.pipelineStats = &pipelineStats;
+        if (!FileHandler::loadDataFiles(dateTree, dataMap, options)) {
+            return 1; //exit if no data loaded
+        }
+        if (options.pipeline) FileHandler::printPipelineStats(std::cout, pipelineStats);
+        monthIndex.build(dataMap);
+        rangeIndex.build(dataMap);
+        if (followSeconds > 0 && !follower.open(dateTree, dataMap, monthIndex, rangeIndex, options)) {
+            return 1;
+        }
+        options.fileRows = NULL;
+    }
+
+    if (follower.IsOpen()) {
+        //queries read published copies, so they never wait for the follower and it never waits for them
+        SnapshotStore store;
+        store.publish(copyOf(data));
+        std::atomic<bool> stop(false);
+        std::thread ingester(ingest, std::ref(follower), std::cref(data), std::ref(store), followSeconds,
+                             std::cref(stop));
+        if (reportRequested || batch) {
+            //everything runs again each time a new version is published, until the program is stopped
+            SnapshotStore::Reader reader(store);
+            for (;;) {
+                const DataSnapshot& current = reader.acquire();
+                long long seen = current.version;
+                runQueries(current, lazy, queries, batch, report, reportRequested, options.threads);
+                reader.release();
+                while (store.GetVersion() == seen) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        Menu::run(store);
+        stop.store(true);
+        ingester.join();
+        return 0;
+    }
+    if (reportRequested || batch) {
+        return runQueries(data, lazy, queries, batch, report, reportRequested, options.threads);
+    }
+    Menu::run(dataMap, monthIndex, rangeIndex, lazy);
     return 0;
 }
@@ -0,0 +1,285 @@
+#include "BatchRunner.h"
+#include "FileHandler.h"
+#include "Parallel.h"
+#include "ReportEngine.h"
+#include "Statistics.h"
+#include "DataUtils.h"
+#include "Timestamp.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+//writes the result rows of one query; year and month are "-" when the query has none
+class RowWriter {
+public:
+    RowWriter(std::ostringstream& os, int id, const std::string& name) : os(os), id(id), name(name), year(0), month(0) {
+        os << std::setprecision(7);
+    }
+
+    void at(int y, int m) {
+        year = y;
+        month = m;
+    }
+
+    void value(const char* field, double v) {
+        start(field);
+        if (std::isnan(v)) os << "nan";
+        else os << v;
+        os << "\n";
+    }
+
+    void count(const char* field, long long n) {
+        start(field);
+        os << n << "\n";
+    }
+
+    void text(const char* field, const std::string& message) {
+        start(field);
+        os << message << "\n";
+    }
+
+private:
+    void start(const char* field) {
+        os << id << "\t" << name << "\t";
+        if (year) os << year;
+        else os << "-";
+        os << "\t";
+        if (month) os << month;
+        else os << "-";
+        os << "\t" << field << "\t";
+    }
+
+    std::ostringstream& os;
+    int id;
+    std::string name;
+    int year, month;
+};
+
+//pearson() throws when there are no pairs, a batch row just says nan
+double correlation(const CrossSums& sums) {
+    try {
+        return pearson(CoMomentAcc::fromSums(sums));
+    } catch (const std::exception&) {
+        return NAN;
+    }
+}
+
+bool readYear(std::istream& is, int& year) {
+    return (is >> year) && year >= 1800 && year <= 2100;
+}
+
+bool readMonth(std::istream& is, int& month) {
+    return (is >> month) && month >= 1 && month <= 12;
+}
+
+}
+
+const char* BatchRunner::kindName(QueryKind kind) {
+    switch (kind) {
+        case QUERY_WIND: return "wind";
+        case QUERY_TEMP: return "temp";
+        case QUERY_CORRELATION: return "corr";
+        case QUERY_REPORT: return "report";
+        case QUERY_RANGE: return "range";
+    }
+    return "?";
+}
+
+//keyword first, then the numbers, nothing may follow
+bool BatchRunner::parseQuery(const std::string& line, BatchQuery& query, std::string& error) {
+    std::istringstream in(line);
+    std::string word;
+    in >> word;
+    query = BatchQuery();
+    bool ok;
+    if (word == "wind") {
+        query.kind = QUERY_WIND;
+        ok = readYear(in, query.year) && readMonth(in, query.month);
+        if (!ok) error = "expected: wind YEAR MONTH";
+    } else if (word == "temp") {
+        query.kind = QUERY_TEMP;
+        ok = readYear(in, query.year);
+        if (!ok) error = "expected: temp YEAR";
+    } else if (word == "corr") {
+        query.kind = QUERY_CORRELATION;
+        ok = readMonth(in, query.month);
+        if (!ok) error = "expected: corr MONTH";
+    } else if (word == "report") {
+        query.kind = QUERY_REPORT;
+        ok = readYear(in, query.year);
+        if (!ok) error = "expected: report YEAR";
+    } else if (word == "range") {
+        query.kind = QUERY_RANGE;
+        Date fromDate, toDate;
+        MyTime fromTime, toTime;
+        FileHandler::readDate(in, fromDate);
+        FileHandler::readTime(in, fromTime);
+        FileHandler::readDate(in, toDate);
+        FileHandler::readTime(in, toTime);
+        ok = !in.fail();
+        if (ok) {
+            query.from = toEpochMinutes(fromDate, fromTime);
+            query.to = toEpochMinutes(toDate, toTime);
+        } else {
+            error = "expected: range dd/mm/yyyy hh:mm dd/mm/yyyy hh:mm";
+        }
+    } else {
+        error = "unknown query: " + word;
+        return false;
+    }
+    if (ok && (in >> word)) {
+        error = "unexpected text after the query: " + word;
+        ok = false;
+    }
+    return ok;
+}
+
+bool BatchRunner::readScript(const std::string& filename, Vector<std::string>& lines) {
+    std::ifstream file;
+    if (filename != "-") {
+        file.open(filename);
+        if (!file.is_open()) return false;
+    }
+    std::istream& in = (filename == "-") ? std::cin : file;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        std::size_t last = line.find_last_not_of(" \t\r");
+        lines.pushBack(line.substr(first, last - first + 1));
+    }
+    return true;
+}
+
+void BatchRunner::prepare(const BatchQuery& query, LazyLoader& lazy) {
+    switch (query.kind) {
+        case QUERY_WIND: lazy.loadMonth(query.year, query.month); break;
+        case QUERY_TEMP: lazy.loadYear(query.year); break;
+        case QUERY_CORRELATION: lazy.loadMonthFirstYear(query.month); break;
+        case QUERY_REPORT: lazy.loadYear(query.year); break;
+        case QUERY_RANGE: lazy.loadRange(query.from, query.to); break;
+    }
+}
+
+//same numbers as the menu options, without the rounding to one decimal
+void BatchRunner::runQuery(const BatchQuery& query, int id, const MonthTable<WeatherLog>& dataMap,
+                           const MonthIndex& index, const RangeIndex& ranges, std::string& result) {
+    std::ostringstream os;
+    RowWriter row(os, id, kindName(query.kind));
+    switch (query.kind) {
+        case QUERY_WIND: {
+            row.at(query.year, query.month);
+            const MonthStats* stats = index.find(query.year, query.month);
+            row.count("rows", stats ? stats->rows : 0);
+            if (!stats || stats->rows == 0) break;
+            MeanVarAcc speeds = MeanVarAcc::fromSums(stats->wind);
+            row.value("wind_avg_kmh", speeds.getMean()*3.6f);
+            row.value("wind_sd_kmh", speeds.getStdev()*3.6f);
+            break;
+        }
+        case QUERY_TEMP:
+            for (int month = 1; month <= 12; month++) {
+                row.at(query.year, month);
+                const MonthStats* stats = index.find(query.year, month);
+                row.count("rows", stats ? stats->rows : 0);
+                if (!stats || stats->rows == 0) continue;
+                MeanVarAcc temps = MeanVarAcc::fromSums(stats->temp);
+                row.value("temp_avg_c", temps.getMean());
+                row.value("temp_sd_c", temps.getStdev());
+            }
+            break;
+        case QUERY_CORRELATION: {
+            //the earliest year with that month, its year goes in the year column
+            int year = 0;
+            const MonthStats* stats = index.firstYear(query.month, year);
+            row.at(year, query.month);
+            row.count("rows", stats ? stats->rows : 0);
+            if (!stats) break;
+            row.value("s_t", correlation(stats->windTemp));
+            row.value("s_r", correlation(stats->windSolar));
+            row.value("t_r", correlation(stats->tempSolar));
+            break;
+        }
+        case QUERY_REPORT:
+            //the values writeAllStats puts in WindTempSolar.csv, and a count of 0 for months without data
+            for (int month = 1; month <= 12; month++) {
+                row.at(query.year, month);
+                const MonthStats* stats = index.find(query.year, month);
+                row.count("rows", stats ? stats->rows : 0);
+                if (!stats || stats->rows == 0) continue;
+                MonthReport report = ReportEngine::monthReport(dataMap, *stats, query.year, month);
+                row.value("wind_avg_kmh", report.windAvg);
+                row.value("wind_sd_kmh", report.windStdev);
+                row.value("wind_mad_kmh", report.windMad);
+                row.value("temp_avg_c", report.tempAvg);
+                row.value("temp_sd_c", report.tempStdev);
+                row.value("temp_mad_c", report.tempMad);
+                row.value("solar_kwh", report.solarTotal);
+            }
+            break;
+        case QUERY_RANGE: {
+            MonthStats stats = ranges.query(query.from, query.to);
+            row.count("rows", stats.rows);
+            if (stats.rows == 0) break;
+            MeanVarAcc speeds = MeanVarAcc::fromSums(stats.wind), temps = MeanVarAcc::fromSums(stats.temp);
+            row.value("wind_avg_kmh", speeds.getMean()*3.6f);
+            row.value("wind_sd_kmh", speeds.getStdev()*3.6f);
+            row.value("temp_avg_c", temps.getMean());
+            row.value("temp_sd_c", temps.getStdev());
+            row.value("solar_kwh", calculateTotalSolar(stats.solar));
+            row.value("s_t", correlation(stats.windTemp));
+            row.value("s_r", correlation(stats.windSolar));
+            row.value("t_r", correlation(stats.tempSolar));
+            break;
+        }
+    }
+    result = os.str();
+}
+
+//parse and load on this thread, answer in parallel, print in order
+int BatchRunner::run(const Vector<std::string>& lines, const MonthTable<WeatherLog>& dataMap,
+                     const MonthIndex& index, const RangeIndex& ranges, LazyLoader& lazy, int threads,
+                     std::ostream& out) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int count = lines.GetSize();
+    Vector<BatchQuery> queries(count, BatchQuery());
+    Vector<std::string> results(count, std::string());
+    Vector<bool> valid(count, false);
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        std::string error;
+        valid[i] = parseQuery(lines[i], queries[i], error);
+        if (!valid[i]) {
+            std::ostringstream os;
+            //the row names the query by its first word, whatever it is
+            RowWriter(os, i + 1, lines[i].substr(0, lines[i].find_first_of(" \t"))).text("error", error);
+            results[i] = os.str();
+            std::cerr << "Query " << i + 1 << " (" << lines[i] << "): " << error << std::endl;
+            failed++;
+            continue;
+        }
+        prepare(queries[i], lazy);
+    }
+    //months loaded after a range query was prepared are added to the range index too
+    lazy.refreshRanges();
+
+    threads = resolveThreadCount(threads);
+    parallelFor(count, threads, [&](int i) {
+        if (valid[i]) runQuery(queries[i], i + 1, dataMap, index, ranges, results[i]);
+    });
+
+    out << "id\tquery\tyear\tmonth\tfield\tvalue\n";
+    for (int i = 0; i < count; i++) out << results[i];
+    out.flush();
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::cerr << "Batch: " << count << " queries (" << failed << " invalid) in " << std::fixed
+              << std::setprecision(1) << took.count() * 1000 << " ms on " << threads << " thread(s), "
+              << std::setprecision(0) << (took.count() > 0 ? count / took.count() : 0.0) << " queries/s"
+              << std::endl;
+    return failed;
+}
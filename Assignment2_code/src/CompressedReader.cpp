@@ -0,0 +1,238 @@
+#include "CompressedReader.h"
+#include <cstring>
+#include <utility>
+
+#ifdef WEATHER_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WEATHER_ZSTD
+#include <zstd.h>
+#endif
+
+const std::size_t CompressedReader::BLOCK_BYTES;
+const int CompressedReader::QUEUE_BLOCKS;
+
+namespace {
+
+bool endsWith(const std::string& text, const char* suffix) {
+    std::size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+}
+
+Compression compressionOf(const std::string& filename) {
+    if (endsWith(filename, ".gz")) return COMPRESSION_GZIP;
+    if (endsWith(filename, ".zst")) return COMPRESSION_ZSTD;
+    return COMPRESSION_NONE;
+}
+
+CompressedReader::CompressedReader()
+    : format(COMPRESSION_NONE), head(0), count(0), done(true), stopping(false) {}
+
+CompressedReader::~CompressedReader() {
+    close();
+}
+
+//maps the file and starts the worker, which runs until the data ends or close() is called
+bool CompressedReader::open(const std::string& filename) {
+    close();
+    error.clear();
+    format = compressionOf(filename);
+#ifndef WEATHER_ZLIB
+    if (format == COMPRESSION_GZIP) error = "Gzip input not supported by this build: ";
+#endif
+#ifndef WEATHER_ZSTD
+    if (format == COMPRESSION_ZSTD) error = "Zstd input not supported by this build: ";
+#endif
+    if (format == COMPRESSION_NONE) error = "Not a compressed file: ";
+    if (!error.empty()) return false;
+    if (!input.open(filename)) {
+        error = "Could not open: ";
+        return false;
+    }
+    head = 0;
+    count = 0;
+    done = false;
+    stopping = false;
+    worker = std::thread(&CompressedReader::run, this);
+    return true;
+}
+
+bool CompressedReader::read(std::string& block) {
+    std::unique_lock<std::mutex> guard(lock);
+    notEmpty.wait(guard, [this]() { return count > 0 || done; });
+    if (count == 0) return false;
+    block.swap(slots[head]);
+    head = (head + 1) % QUEUE_BLOCKS;
+    count--;
+    notFull.notify_one();
+    return true;
+}
+
+void CompressedReader::close() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        notFull.notify_one();
+        worker.join();
+    }
+    input.close();
+    for (int i = 0; i < QUEUE_BLOCKS; i++) std::string().swap(slots[i]);
+    count = 0;
+    done = true;
+}
+
+bool CompressedReader::Failed() const {
+    return !error.empty();
+}
+
+const std::string& CompressedReader::GetError() const {
+    return error;
+}
+
+//drains a reader into one string, used where the text is needed all at once
+bool CompressedReader::readAll(const std::string& filename, std::string& text, std::string& error) {
+    text.clear();
+    CompressedReader reader;
+    if (!reader.open(filename)) {
+        error = reader.GetError() + filename;
+        return false;
+    }
+    std::string block;
+    while (reader.read(block)) text.append(block);
+    if (reader.Failed()) {
+        error = reader.GetError() + filename;
+        text.clear();
+        return false;
+    }
+    return true;
+}
+
+void CompressedReader::run() {
+    bool ok = (format == COMPRESSION_GZIP) ? inflateGzip() : decompressZstd();
+    //a damaged file sets error itself, a stop from close() is not an error
+    if (ok) finish("");
+    else finish(error.empty() ? "Could not decompress: " : error);
+}
+
+bool CompressedReader::push(std::string& block) {
+    std::unique_lock<std::mutex> guard(lock);
+    notFull.wait(guard, [this]() { return count < QUEUE_BLOCKS || stopping; });
+    if (stopping) return false;
+    slots[(head + count) % QUEUE_BLOCKS].swap(block);
+    count++;
+    notEmpty.notify_one();
+    block.clear();
+    return true;
+}
+
+void CompressedReader::finish(const std::string& message) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!stopping) error = message;
+    done = true;
+    notEmpty.notify_one();
+}
+
+//inflates gzip members one after another until the input ends
+bool CompressedReader::inflateGzip() {
+#ifdef WEATHER_ZLIB
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(input.GetData());
+    std::size_t left = input.GetSize();
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    //15 + 16: gzip wrapper only, with the largest window
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) return false;
+
+    std::string block(BLOCK_BYTES, '\0');
+    std::size_t filled = 0;
+    bool ok = true, inMember = false;
+    while (ok) {
+        //avail_in is 32 bits, larger files are fed in pieces
+        if (zs.avail_in == 0 && left > 0) {
+            uInt piece = left > (1u << 30) ? (1u << 30) : static_cast<uInt>(left);
+            zs.next_in = const_cast<Bytef*>(in);
+            zs.avail_in = piece;
+            in += piece;
+            left -= piece;
+        }
+        if (zs.avail_in == 0 && left == 0 && !inMember) break;
+        zs.next_out = reinterpret_cast<Bytef*>(&block[filled]);
+        zs.avail_out = static_cast<uInt>(BLOCK_BYTES - filled);
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        filled = BLOCK_BYTES - zs.avail_out;
+        inMember = true;
+        if (ret == Z_STREAM_END) {
+            //another member may follow
+            inMember = false;
+            inflateReset(&zs);
+        } else if (ret == Z_BUF_ERROR && zs.avail_in == 0 && left == 0) {
+            error = "Compressed data cut short: ";
+            ok = false;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            error = "Damaged compressed data: ";
+            ok = false;
+        }
+        if (filled == BLOCK_BYTES) {
+            if (!push(block)) break;
+            block.resize(BLOCK_BYTES);
+            filled = 0;
+        }
+    }
+    inflateEnd(&zs);
+    if (ok && filled > 0) {
+        block.resize(filled);
+        push(block);
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
+
+//streams zstd frames one after another until the input ends
+bool CompressedReader::decompressZstd() {
+#ifdef WEATHER_ZSTD
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    if (!dctx) return false;
+    ZSTD_inBuffer in = {input.GetData(), input.GetSize(), 0};
+    std::string block(BLOCK_BYTES, '\0');
+    std::size_t filled = 0;
+    std::size_t pendingFrame = 0; //non zero while a frame is not finished
+    bool ok = true, stopped = false, outputFull = false;
+    while (in.pos < in.size || outputFull) {
+        ZSTD_outBuffer out = {&block[filled], BLOCK_BYTES - filled, 0};
+        pendingFrame = ZSTD_decompressStream(dctx, &out, &in);
+        if (ZSTD_isError(pendingFrame)) {
+            error = "Damaged compressed data: ";
+            ok = false;
+            break;
+        }
+        filled += out.pos;
+        //a full output buffer can leave data inside the decoder
+        outputFull = out.pos == out.size;
+        if (filled == BLOCK_BYTES) {
+            if (!push(block)) {
+                stopped = true;
+                break;
+            }
+            block.resize(BLOCK_BYTES);
+            filled = 0;
+        }
+    }
+    ZSTD_freeDCtx(dctx);
+    if (ok && !stopped && pendingFrame != 0 && in.pos == in.size) {
+        error = "Compressed data cut short: ";
+        ok = false;
+    }
+    if (ok && filled > 0) {
+        block.resize(filled);
+        push(block);
+    }
+    return ok;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,243 @@
+#include "DataCache.h"
+#include "MappedFile.h"
+#include "Timestamp.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <sys/stat.h>
+
+namespace {
+
+const char MAGIC[4] = {'W', 'S', 'C', '1'};
+const unsigned BYTE_ORDER_MARK = 0x01020304u;
+
+//bounds checked reads from the mapped cache, any overrun marks the cache as damaged
+struct CacheReader {
+    const char* p;
+    const char* end;
+    bool ok;
+
+    template<typename T>
+    bool read(T& value) {
+        if (!ok || static_cast<std::size_t>(end - p) < sizeof(T)) return ok = false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    //returns the start of the next n bytes and skips them
+    const char* take(std::size_t n) {
+        if (!ok || static_cast<std::size_t>(end - p) < n) {
+            ok = false;
+            return NULL;
+        }
+        const char* start = p;
+        p += n;
+        return start;
+    }
+};
+
+template<typename T>
+void append(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//64-bit FNV-1a, taking eight bytes per step so hashing keeps up with the disk
+unsigned long long hashBytes(const char* data, std::size_t size) {
+    const unsigned long long prime = 1099511628211ULL;
+    unsigned long long h = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * prime;
+    }
+    for (; i < size; i++) h = (h ^ static_cast<unsigned char>(data[i])) * prime;
+    return h ^ size;
+}
+
+bool sameSource(const SourceStamp& stamp, const std::string& name, long long size, long long mtime,
+                unsigned long long hash) {
+    return stamp.valid && stamp.name == name && stamp.size == size && stamp.mtime == mtime && stamp.hash == hash;
+}
+
+//decodes one month block into the shard, or just skips it when shard is NULL
+bool readMonth(CacheReader& in, FieldSet extraFields, LoadShard* shard) {
+    int year, month, rows;
+    if (!in.read(year) || !in.read(month) || !in.read(rows) || rows < 0) return false;
+    std::size_t n = static_cast<std::size_t>(rows);
+    const char* stamps = in.take(n * sizeof(int));
+    const char* wind = in.take(n * sizeof(float));
+    const char* temp = in.take(n * sizeof(float));
+    const char* solar = in.take(n * sizeof(float));
+    const char* extras[FIELD_COUNT];
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        extras[f] = (extraFields & fieldBit(f)) ? in.take(n * sizeof(float)) : NULL;
+    }
+    if (!in.ok || !shard) return in.ok;
+    if (!isStampDate(year, month, 1)) return false;
+    //every reading must fall inside the block's month
+    int monthStart = daysFromCivil(year, month, 1) * 1440;
+    int monthEnd = monthStart + daysInMonth(year, month) * 1440;
+    for (std::size_t i = 0; i < n; i++) {
+        int minutes;
+        std::memcpy(&minutes, stamps + i * sizeof(int), sizeof(int));
+        if (minutes < monthStart || minutes >= monthEnd) return false;
+    }
+
+    int key = monthKey(year, month);
+    WeatherLog& log = shard->dataMap[key];
+    shard->dateTree.insert(key);
+    log.reserve(log.GetSize() + rows);
+    float values[FIELD_COUNT];
+    for (std::size_t i = 0; i < n; i++) {
+        WeatherEntry w;
+        std::memcpy(&w.minutes, stamps + i * sizeof(int), sizeof(int));
+        std::memcpy(&w.windSpeed, wind + i * sizeof(float), sizeof(float));
+        std::memcpy(&w.temperature, temp + i * sizeof(float), sizeof(float));
+        std::memcpy(&w.solarRadiation, solar + i * sizeof(float), sizeof(float));
+        if (!extraFields) {
+            log.pushBack(w);
+            continue;
+        }
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (extras[f]) std::memcpy(&values[f], extras[f] + i * sizeof(float), sizeof(float));
+        }
+        log.pushBack(w, values, extraFields);
+    }
+    return true;
+}
+
+}
+
+//size and mtime from stat, hash from a mapping of the contents
+void DataCache::stampFile(const std::string& path, const std::string& name, SourceStamp& stamp) {
+    stamp = SourceStamp();
+    stamp.name = name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return;
+    MappedFile file;
+    if (!file.open(path)) return;
+    stamp.size = static_cast<long long>(file.GetSize());
+    stamp.mtime = static_cast<long long>(st.st_mtime);
+    stamp.hash = hashBytes(file.GetData(), file.GetSize());
+    stamp.endsLine = file.GetSize() == 0 || file.GetData()[file.GetSize() - 1] == '\n';
+    stamp.valid = true;
+}
+
+//restore every section whose source is unchanged
+int DataCache::restore(const std::string& cacheFile, const Vector<SourceStamp>& stamps, Vector<LoadShard>& shards,
+                       FieldSet fields) {
+    MappedFile file;
+    if (!file.open(cacheFile) || file.GetSize() == 0) return 0;
+    CacheReader in = {file.GetData(), file.GetData() + file.GetSize(), true};
+
+    const char* magic = in.take(sizeof(MAGIC));
+    unsigned mark, version, cachedFields, sections;
+    if (!magic || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return 0;
+    if (!in.read(mark) || mark != BYTE_ORDER_MARK) return 0;
+    if (!in.read(version) || version != FORMAT_VERSION) return 0;
+    if (!in.read(cachedFields) || cachedFields != (fields | CORE_FIELDS)) return 0;
+    FieldSet extraFields = cachedFields & ~CORE_FIELDS;
+    if (!in.read(sections)) return 0;
+
+    //decode into side shards first, a damaged file must not leave half filled shards behind
+    Vector<LoadShard> restored(shards.GetSize(), LoadShard());
+    for (unsigned s = 0; s < sections; s++) {
+        unsigned nameLength, months;
+        long long size, mtime;
+        unsigned long long hash;
+        if (!in.read(nameLength)) return 0;
+        const char* namePtr = in.take(nameLength);
+        if (!in.read(size) || !in.read(mtime) || !in.read(hash) || !in.read(months)) return 0;
+        std::string name(namePtr, nameLength);
+
+        LoadShard* target = NULL;
+        for (int i = 0; i < stamps.GetSize(); i++) {
+            if (!restored[i].loaded && !shards[i].loaded && sameSource(stamps[i], name, size, mtime, hash)) {
+                target = &restored[i];
+                break;
+            }
+        }
+        for (unsigned m = 0; m < months; m++) {
+            if (!readMonth(in, extraFields, target)) return 0;
+        }
+        if (target) target->loaded = true;
+    }
+
+    int count = 0;
+    for (int i = 0; i < shards.GetSize(); i++) {
+        if (!restored[i].loaded) continue;
+        shards[i] = std::move(restored[i]);
+        count++;
+    }
+    return count;
+}
+
+//write the loaded shards as one buffer, then swap the file in
+bool DataCache::save(const std::string& cacheFile, const Vector<SourceStamp>& stamps, const Vector<LoadShard>& shards,
+                     FieldSet fields) {
+    fields |= CORE_FIELDS;
+    FieldSet extraFields = fields & ~CORE_FIELDS;
+    std::string out;
+    unsigned sections = 0;
+    for (int i = 0; i < shards.GetSize(); i++) {
+        if (shards[i].loaded && stamps[i].valid) sections++;
+    }
+    out.append(MAGIC, sizeof(MAGIC));
+    append(out, BYTE_ORDER_MARK);
+    unsigned version = FORMAT_VERSION;
+    append(out, version);
+    append(out, static_cast<unsigned>(fields));
+    append(out, sections);
+
+    for (int i = 0; i < shards.GetSize(); i++) {
+        if (!shards[i].loaded || !stamps[i].valid) continue;
+        const SourceStamp& stamp = stamps[i];
+        append(out, static_cast<unsigned>(stamp.name.size()));
+        out.append(stamp.name);
+        append(out, stamp.size);
+        append(out, stamp.mtime);
+        append(out, stamp.hash);
+        append(out, static_cast<unsigned>(shards[i].dataMap.GetCount()));
+
+        shards[i].dataMap.forEach([&out, extraFields](int key, const WeatherLog& log) {
+            int rows = log.GetSize();
+            append(out, keyYear(key));
+            append(out, keyMonth(key));
+            append(out, rows);
+            //the columns are already contiguous, copy them in one go
+            out.append(reinterpret_cast<const char*>(log.GetTimestamps().GetData()), rows * sizeof(int));
+            out.append(reinterpret_cast<const char*>(log.GetWindSpeeds().GetData()), rows * sizeof(float));
+            out.append(reinterpret_cast<const char*>(log.GetTemperatures().GetData()), rows * sizeof(float));
+            out.append(reinterpret_cast<const char*>(log.GetSolarRadiation().GetData()), rows * sizeof(float));
+            for (int f = 0; f < FIELD_COUNT; f++) {
+                if (!(extraFields & fieldBit(f))) continue;
+                ColumnView<float> column = log.GetColumn(f);
+                if (column.GetSize() == rows) {
+                    out.append(reinterpret_cast<const char*>(column.GetData()), rows * sizeof(float));
+                } else {
+                    const float missing = NAN;
+                    for (int r = 0; r < rows; r++) append(out, missing);
+                }
+            }
+        });
+    }
+
+    std::string tmpFile = cacheFile + ".tmp";
+    {
+        std::ofstream file(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            file.close();
+            std::remove(tmpFile.c_str());
+            return false;
+        }
+    }
+    //rename does not replace an existing file on Windows
+    std::remove(cacheFile.c_str());
+    return std::rename(tmpFile.c_str(), cacheFile.c_str()) == 0;
+}
@@ -1,56 +1,33 @@
 #include "DataUtils.h"
 #include "Vector.h"
 #include <cmath>
-#include <sstream>
 
-WeatherLog getRecordsByYearMonth(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int year, int month) {
-    //to gather all BST keys
-    Vector<std::string> keys;
-    tree.InOrder([](const std::string& s){});
-    //compose key as year/month
-    std::stringstream keyBuilder;
-    keyBuilder << year << "-";
-    if(month < 10) keyBuilder << "0";
-    keyBuilder << month;
-    std::string key = keyBuilder.str();
-
-    auto it = dataMap.find(key);
-    if(it != dataMap.end()) return it->second;
-    return WeatherLog();
+WeatherLogView getRecordsByYearMonth(const MonthTable<WeatherLog>& dataMap, int year, int month) {
+    const WeatherLog* log = dataMap.find(monthKey(year, month));
+    if(log) return WeatherLogView(*log);
+    return WeatherLogView();
 }
 
-WeatherLog getRecordsByMonth(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int month) {
-    Vector<std::string> keys;
-    tree.InOrder([](const std::string& s){});
-    for(const auto& pair : dataMap) {
-        std::string key = pair.first;
-        int foundMonth = std::stoi(key.substr(5,2));
-        if(foundMonth == month) return pair.second;
-    }
-    return WeatherLog();
+ColumnView<float> extractWindSpeeds(const WeatherLogView& records) {
+    return records.GetWindSpeeds();
 }
-
-Vector<float> extractWindSpeeds(const WeatherLog& records) {
-    Vector<float> wind;
-    for(int i=0; i<records.GetSize(); i++) wind.pushBack(records[i].windSpeed);
-    return wind;
+ColumnView<float> extractTemperatures(const WeatherLogView& records) {
+    return records.GetTemperatures();
 }
-Vector<float> extractTemperatures(const WeatherLog& records) {
-    Vector<float> temp;
-    for(int i=0; i<records.GetSize(); i++) temp.pushBack(records[i].temperature);
-    return temp;
+ColumnView<float> extractSolarRadiation(const WeatherLogView& records) {
+    return records.GetSolarRadiation();
 }
-Vector<float> extractSolarRadiation(const WeatherLog& records) {
-    Vector<float> solar;
-    for(int i=0; i<records.GetSize(); i++) {
-        float sr = records[i].solarRadiation;
-        if(!std::isnan(sr) && sr >= 100) solar.pushBack(sr);
-    }
-    return solar;
-}
-float calculateTotalSolar(const Vector<float>& solarVals) {
+float calculateTotalSolar(const ColumnView<float>& solarVals) {
     float total = 0.0f;
-    for(int i=0; i<solarVals.GetSize(); i++)
-        total += solarVals[i] * (10.0f / 60.0f) / 1000.0f; //to convert Wh to kWh
+    const float* sr = solarVals.GetData();
+    for(int i=0; i<solarVals.GetSize(); i++) {
+        //only readings of 100 W/m^2 or more count
+        if(!std::isnan(sr[i]) && sr[i] >= 100)
+            total += sr[i] * (10.0f / 60.0f) / 1000.0f; //to convert Wh to kWh
+    }
     return std::round(total*10.0f)/10.0f;
 }
+float calculateTotalSolar(const NanSums& counted) {
+    double total = counted.sum * (10.0 / 60.0) / 1000.0; //to convert Wh to kWh
+    return std::round(static_cast<float>(total)*10.0f)/10.0f;
+}
@@ -0,0 +1,18 @@
+#include "FastParse.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+//copies the field to a null-terminated buffer for strtof, cells this long are never numbers
+ParseStatus scanDecimalSlow(const char* begin, const char* end, float& value) {
+    char buf[64];
+    std::size_t length = static_cast<std::size_t>(end - begin);
+    if (length >= sizeof(buf)) return PARSE_SYNTAX;
+    std::memcpy(buf, begin, length);
+    buf[length] = '\0';
+    char* stop = NULL;
+    errno = 0;
+    value = std::strtof(buf, &stop);
+    if (stop == buf) return PARSE_SYNTAX;
+    return errno == ERANGE ? PARSE_RANGE : PARSE_OK;
+}
@@ -1,9 +1,184 @@
 
 #include "FileHandler.h"
+#include "CompressedReader.h"
+#include "DataCache.h"
+#include "FastParse.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "SpscRing.h"
+#include "Timestamp.h"
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace {
+
+//a file is only split into chunks of at least this many bytes
+const std::size_t MIN_CHUNK_BYTES = 1 << 20;
+
+//pipeline blocks are about this size, then cut back to the last newline
+const std::size_t PIPELINE_BLOCK_BYTES = 1 << 20;
+
+//blocks that can wait between two pipeline stages, per parser worker
+const int PIPELINE_RING_BLOCKS = 4;
+
+std::mutex errorLock;
+
+//loader messages can come from several workers, keep each line whole
+void reportError(const std::string& message, const std::string& filename) {
+    std::lock_guard<std::mutex> guard(errorLock);
+    std::cerr << message << filename << std::endl;
+}
+
+//hands out a file's text in blocks of whole lines, read with fread or from the decompressor
+class LineBlockSource {
+public:
+    LineBlockSource() : file(NULL), compressed(false), wholeLines(false), handedOut(0) {}
+    ~LineBlockSource() { close(); }
+
+    //on failure message is set to the text to print before the file name
+    bool open(const std::string& filename, std::string& message) {
+        compressed = compressionOf(filename) != COMPRESSION_NONE;
+        if (compressed) {
+            if (packed.open(filename)) return true;
+            message = packed.GetError();
+            return false;
+        }
+        file = std::fopen(filename.c_str(), "rb");
+        if (!file) message = "Could not open: ";
+        return file != NULL;
+    }
+
+    //a plain file's last line is left out if it has no newline, GetHandedOut() then tells where it starts
+    void keepWholeLines() {
+        wholeLines = true;
+    }
+
+    //bytes of the file handed out in blocks so far
+    long long GetHandedOut() const {
+        return handedOut;
+    }
+
+    //the last block can end without a newline, false once everything was handed out
+    bool next(std::string& block) {
+        while (true) {
+            if (compressed) {
+                if (!packed.read(raw)) return takeCarry(block);
+                const char* begin = raw.data();
+                const char* last = lastLineEnd(begin, begin + raw.size());
+                if (!last) {
+                    carry.append(raw);
+                    continue;
+                }
+                block.assign(carry);
+                block.append(begin, last - begin);
+                carry.assign(last, begin + raw.size() - last);
+                handedOut += static_cast<long long>(block.size());
+                return true;
+            }
+            std::size_t kept = carry.size();
+            block.assign(carry);
+            block.resize(kept + PIPELINE_BLOCK_BYTES);
+            std::size_t got = std::fread(&block[kept], 1, PIPELINE_BLOCK_BYTES, file);
+            if (got == 0) {
+                block.clear();
+                return takeCarry(block);
+            }
+            block.resize(kept + got);
+            const char* begin = block.data();
+            const char* last = lastLineEnd(begin + kept, begin + block.size());
+            if (!last) {
+                carry.swap(block);
+                continue;
+            }
+            carry.assign(last, begin + block.size() - last);
+            block.resize(last - begin);
+            handedOut += static_cast<long long>(block.size());
+            return true;
+        }
+    }
+
+    //true if the data ended early because it could not be read
+    bool failed(std::string& message) {
+        if (compressed && packed.Failed()) message = packed.GetError();
+        else if (!compressed && file && std::ferror(file)) message = "Could not read: ";
+        else return false;
+        return true;
+    }
+
+    void close() {
+        if (file) std::fclose(file);
+        file = NULL;
+        packed.close();
+    }
+
+private:
+    //one past the last newline in the range, NULL if there is none
+    static const char* lastLineEnd(const char* begin, const char* end) {
+        while (end != begin && end[-1] != '\n') --end;
+        return end == begin ? NULL : end;
+    }
+
+    bool takeCarry(std::string& block) {
+        if (carry.empty() || (wholeLines && !compressed)) return false;
+        handedOut += static_cast<long long>(carry.size());
+        block.swap(carry);
+        carry.clear();
+        return true;
+    }
+
+    std::FILE* file;
+    bool compressed;
+    CompressedReader packed;
+    std::string raw;   //block from the decompressor
+    std::string carry; //start of a line cut by the end of the last block
+    bool wholeLines;   //the carry left at the end is not handed out
+    long long handedOut;
+};
+
+//a block of lines on its way through the pipeline, and the rows parsed from it
+struct PipelineBlock {
+    std::string text;
+    LoadShard rows;
+};
+
+typedef SpscRing<PipelineBlock*> BlockRing;
+
+//a stalled stage yields this many times, then sleeps between tries so it stops taking turns from busy stages
+const int PIPELINE_YIELDS = 16;
+
+void waitTurn(int& tries) {
+    if (++tries <= PIPELINE_YIELDS) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+//pushes to a ring, waiting while it is full; one wait is counted per stall
+void pushWaiting(BlockRing& ring, PipelineBlock* block, long long& waits) {
+    if (ring.tryPush(block)) return;
+    waits++;
+    int tries = 0;
+    while (!ring.tryPush(block)) waitTurn(tries);
+}
+
+//pops from a ring, waiting while it is empty; one wait is counted per stall
+PipelineBlock* popWaiting(BlockRing& ring, long long& waits) {
+    PipelineBlock* block;
+    if (ring.tryPop(block)) return block;
+    waits++;
+    int tries = 0;
+    while (!ring.tryPop(block)) waitTurn(tries);
+    return block;
+}
+
+}
 
 //reads user input in day/month/year format into a Date object
 std::istream& FileHandler::readDate(std::istream& is, Date& date) {
@@ -89,24 +264,422 @@ int FileHandler::promptMonth() {
     }
 }
 
+//prompt user for a date and time as dd/mm/yyyy hh:mm (with repeat on invalid entry)
+void FileHandler::promptDateTime(const std::string& label, Date& date, MyTime& time) {
+    while (true) {
+        std::cout << "Enter " << label << " date and time (dd/mm/yyyy hh:mm): ";
+        readDate(std::cin, date);
+        readTime(std::cin, time);
+        if (std::cin.fail()) {
+            std::cin.clear();
+            std::cin.ignore(10000, '\n');
+            std::cout << "Invalid date or time, please try again." << std::endl;
+        } else {
+            return;
+        }
+    }
+}
+
 //loads all files listed in data/data_source.txt into structures
-bool FileHandler::loadDataFiles(BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap) {
-    std::ifstream srcList("data/data_source.txt");
-    if (!srcList.is_open()) {
+bool FileHandler::loadDataFiles(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap) {
+    return loadDataFiles(dateTree, dataMap, LoadOptions());
+}
+
+//loads the listed files from the cache or by parsing, serially or one file per worker
+bool FileHandler::loadDataFiles(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                const LoadOptions& options) {
+    Vector<std::string> files;
+    if (!readSourceList("data/data_source.txt", files)) {
         std::cerr << "Could not open data_source.txt" << std::endl;
         return false;
     }
+    int threads = resolveThreadCount(options.threads);
+    Vector<LoadShard> shards(files.GetSize(), LoadShard());
+
+    //files whose stamp matches the cache are restored instead of parsed
+    Vector<SourceStamp> stamps(files.GetSize(), SourceStamp());
+    if (options.useCache) {
+        parallelFor(files.GetSize(), threads, [&](int i) {
+            DataCache::stampFile("data/" + files[i], files[i], stamps[i]);
+            //a followed file is only loaded up to its last newline, which the cached rows may go past
+            if (options.fileRows && !stamps[i].endsLine && compressionOf(files[i]) == COMPRESSION_NONE) {
+                stamps[i].valid = false;
+            }
+        });
+        DataCache::restore(options.cacheFile, stamps, shards, options.fields);
+    }
+    Vector<int> pending;
+    for (int i = 0; i < files.GetSize(); i++) {
+        if (!shards[i].loaded) pending.pushBack(i);
+    }
+
+    //each worker fills its own shard, nothing shared while parsing.
+    //threads left over when there are fewer files than threads split the files into chunks
+    Vector<PipelineStats> fileStats(files.GetSize(), PipelineStats());
+    Vector<long long> ends(files.GetSize(), 0LL);
+    for (int i = 0; i < files.GetSize(); i++) {
+        if (shards[i].loaded && compressionOf(files[i]) == COMPRESSION_NONE) ends[i] = stamps[i].size;
+    }
+    if (pending.GetSize() > 0) {
+        int chunkThreads = threads / pending.GetSize();
+        if (chunkThreads < 1) chunkThreads = 1;
+        parallelFor(pending.GetSize(), threads, [&](int p) {
+            int i = pending[p];
+            LoadShard& shard = shards[i];
+            long long* end = options.fileRows ? &ends[i] : NULL;
+            if (options.pipeline) {
+                shard.loaded = parseCSVPipelined("data/" + files[i], shard.dateTree, shard.dataMap, chunkThreads,
+                                                 options.fields, fileStats[i], end);
+            } else {
+                shard.loaded = parseCSV("data/" + files[i], shard.dateTree, shard.dataMap, chunkThreads,
+                                        options.fields, end);
+            }
+        });
+    }
+    if (options.pipelineStats) {
+        for (int p = 0; p < pending.GetSize(); p++) options.pipelineStats->add(fileStats[pending[p]]);
+    }
+
+    //the cache is written before merging, which moves the records out of the shards
+    bool loaded = false, parsed = false;
+    for (int p = 0; p < pending.GetSize(); p++) {
+        if (shards[pending[p]].loaded) parsed = true;
+    }
+    if (options.useCache && parsed && !DataCache::save(options.cacheFile, stamps, shards, options.fields)) {
+        std::cerr << "Could not write cache: " << options.cacheFile << std::endl;
+    }
+
+    //merge in list order so rows end up where a serial load puts them
+    if (options.fileRows) options.fileRows->Clear();
+    for (int i = 0; i < shards.GetSize(); i++) {
+        if (options.fileRows) {
+            FileRows& added = options.fileRows->emplaceBack();
+            added.name = files[i];
+            added.loaded = shards[i].loaded;
+            added.end = ends[i];
+            shards[i].dataMap.forEach([&added](int key, const WeatherLog& log) { added.rows[key] = log.GetSize(); });
+        }
+        if (!shards[i].loaded) continue;
+        mergeShard(shards[i], dateTree, dataMap);
+        loaded = true;
+    }
+    return loaded;
+}
+
+//reads data file names, one per line
+bool FileHandler::readSourceList(const std::string& listFile, Vector<std::string>& files) {
+    std::ifstream srcList(listFile);
+    if (!srcList.is_open()) return false;
     std::string filename;
-    bool loaded = false;
     while (std::getline(srcList, filename)) {
         if (filename.empty()) continue;
-        if (parseCSV("data/" + filename, dateTree, dataMap)) loaded = true;
+        files.pushBack(filename);
     }
-    return loaded;
+    return true;
+}
+
+//append shard records after the ones already in the table
+void FileHandler::mergeShard(LoadShard& shard, BST<int>& dateTree,
+                             MonthTable<WeatherLog>& dataMap) {
+    shard.dataMap.forEach([&](int key, WeatherLog& log) {
+        WeatherLog& target = dataMap[key];
+        //a new month takes the shard's columns, an existing one gets the rows appended
+        if (target.GetSize() == 0) target = std::move(log);
+        else target.append(log);
+        dateTree.insert(key);
+    });
+}
+
+//parses one memory-mapped CSV file in place, populates BST and map
+bool FileHandler::parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap) {
+    return parseCSV(filename, dateTree, dataMap, 1);
+}
+
+//parses the core columns of one memory-mapped CSV file
+bool FileHandler::parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                           int threads) {
+    return parseCSV(filename, dateTree, dataMap, threads, CORE_FIELDS);
+}
+
+//parses one memory-mapped CSV file, split into newline aligned chunks when threads > 1
+bool FileHandler::parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                           int threads, FieldSet fields) {
+    return parseCSV(filename, dateTree, dataMap, threads, fields, NULL);
+}
+
+bool FileHandler::parseCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                           int threads, FieldSet fields, long long* wholeLines) {
+    if (wholeLines) *wholeLines = 0;
+    //compressed files are streamed, their chunks only exist once decompressed
+    if (compressionOf(filename) != COMPRESSION_NONE) return parseCompressedCSV(filename, dateTree, dataMap, fields);
+    MappedFile file;
+    if (!file.open(filename)) {
+        reportError("Could not open: ", filename);
+        return false;
+    }
+    const char* p = file.GetData();
+    const char* end = p + file.GetSize();
+    //a line still being written is left to whoever follows the file from here
+    if (wholeLines) {
+        while (end != p && end[-1] != '\n') --end;
+        *wholeLines = static_cast<long long>(end - p);
+    }
+    if (p == end) {
+        reportError("Empty CSV or unreadable: ", filename);
+        return false;
+    }
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!eol) eol = end;
+    ParsePlan plan;
+    //without all four core columns every row would be skipped
+    if (!plan.build(buildColumnMap(std::string(p, eol)), fields)) return true;
+    p = (eol == end) ? end : eol + 1;
+
+    //small files are not worth splitting
+    std::size_t bodySize = end - p;
+    int chunks = static_cast<int>(bodySize / MIN_CHUNK_BYTES);
+    if (chunks > threads) chunks = threads;
+    if (chunks <= 1) {
+        parseRows(p, end, plan, dateTree, dataMap);
+        return true;
+    }
+
+    //chunk i starts after the first newline at or past its even share of the body
+    Vector<const char*> bounds(chunks + 1);
+    bounds.pushBack(p);
+    for (int i = 1; i < chunks; i++) {
+        const char* cut = p + bodySize / chunks * i;
+        if (cut < bounds[i - 1]) cut = bounds[i - 1];
+        const char* nl = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        bounds.pushBack(nl ? nl + 1 : end);
+    }
+    bounds.pushBack(end);
+
+    Vector<LoadShard> shards(chunks, LoadShard());
+    parallelFor(chunks, threads, [&](int i) {
+        parseRows(bounds[i], bounds[i + 1], plan, shards[i].dateTree, shards[i].dataMap);
+    });
+    //chunks are merged in file order, which keeps each month's rows in the order a serial parse gives
+    for (int i = 0; i < chunks; i++) mergeShard(shards[i], dateTree, dataMap);
+    return true;
 }
 
-//parses one CSV file for weather data, populates BST and map
-bool FileHandler::parseCSV(const std::string& filename, BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap) {
+//parses blocks from the decompressing thread as they come, a line cut by a block end is carried over
+bool FileHandler::parseCompressedCSV(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                     FieldSet fields) {
+    CompressedReader reader;
+    if (!reader.open(filename)) {
+        reportError(reader.GetError(), filename);
+        return false;
+    }
+    //rows go to a shard first so a damaged file adds nothing
+    LoadShard shard;
+    ParsePlan plan;
+    bool haveHeader = false, usable = true, empty = true;
+    std::string block, carry;
+    auto consume = [&](const char* p, const char* end) {
+        if (!haveHeader) {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+            haveHeader = true;
+            //without all four core columns every row would be skipped
+            usable = plan.build(buildColumnMap(std::string(p, eol)), fields);
+            p = (eol == end) ? end : eol + 1;
+        }
+        if (usable) parseRows(p, end, plan, shard.dateTree, shard.dataMap);
+    };
+    while (reader.read(block)) {
+        if (block.empty()) continue;
+        empty = false;
+        const char* p = block.data();
+        const char* end = p + block.size();
+        if (!carry.empty()) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!nl) {
+                carry.append(p, end);
+                continue;
+            }
+            carry.append(p, nl + 1);
+            consume(carry.data(), carry.data() + carry.size());
+            carry.clear();
+            p = nl + 1;
+        }
+        const char* last = end;
+        while (last != p && last[-1] != '\n') --last;
+        if (last != p) consume(p, last);
+        carry.assign(last, end);
+    }
+    if (reader.Failed()) {
+        reportError(reader.GetError(), filename);
+        return false;
+    }
+    if (empty) {
+        reportError("Empty CSV or unreadable: ", filename);
+        return false;
+    }
+    if (!carry.empty()) consume(carry.data(), carry.data() + carry.size());
+    mergeShard(shard, dateTree, dataMap);
+    return true;
+}
+
+//reader thread -> one ring per parser -> one ring per parser -> indexer on this thread.
+//blocks are dealt out round robin, so the indexer gets them back in file order by visiting the rings in turn
+bool FileHandler::parseCSVPipelined(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                    int parsers, FieldSet fields, PipelineStats& stats) {
+    return parseCSVPipelined(filename, dateTree, dataMap, parsers, fields, stats, NULL);
+}
+
+bool FileHandler::parseCSVPipelined(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap,
+                                    int parsers, FieldSet fields, PipelineStats& stats, long long* wholeLines) {
+    if (parsers < 1) parsers = 1;
+    if (wholeLines) *wholeLines = 0;
+    LineBlockSource source;
+    std::string message;
+    if (!source.open(filename, message)) {
+        reportError(message, filename);
+        return false;
+    }
+    bool cut = wholeLines && compressionOf(filename) == COMPRESSION_NONE;
+    if (cut) source.keepWholeLines();
+    //the header is read here, every parser needs the plan before it starts
+    std::string first;
+    if (!source.next(first)) {
+        reportError(source.failed(message) ? message : "Empty CSV or unreadable: ", filename);
+        return false;
+    }
+    const char* begin = first.data();
+    const char* eol = static_cast<const char*>(std::memchr(begin, '\n', first.size()));
+    if (!eol) eol = begin + first.size();
+    ParsePlan plan;
+    //without all four core columns every row would be skipped
+    if (!plan.build(buildColumnMap(std::string(begin, eol)), fields)) return true;
+    first.erase(0, eol == begin + first.size() ? first.size() : eol - begin + 1);
+
+    Vector<BlockRing*> toParser, toIndexer;
+    for (int i = 0; i < parsers; i++) {
+        toParser.pushBack(new BlockRing(PIPELINE_RING_BLOCKS));
+        toIndexer.pushBack(new BlockRing(PIPELINE_RING_BLOCKS));
+    }
+    Vector<StageCounters> parserCounters(parsers, StageCounters());
+    StageCounters readerCounters, indexerCounters;
+    bool readFailed = false;
+
+    //a NULL block tells a parser, and through it the indexer, that the file has ended
+    std::thread reader([&]() {
+        int turn = 0;
+        PipelineBlock* block = new PipelineBlock;
+        block->text.swap(first);
+        do {
+            if (block->text.empty()) continue;
+            pushWaiting(*toParser[turn], block, readerCounters.fullWaits);
+            readerCounters.blocks++;
+            turn = (turn + 1) % parsers;
+            block = new PipelineBlock;
+        } while (source.next(block->text));
+        delete block;
+        readFailed = source.failed(message);
+        for (int i = 0; i < parsers; i++) {
+            pushWaiting(*toParser[(turn + i) % parsers], NULL, readerCounters.fullWaits);
+        }
+    });
+    Vector<std::thread*> workers;
+    for (int i = 0; i < parsers; i++) {
+        workers.pushBack(new std::thread([&, i]() {
+            StageCounters& counters = parserCounters[i];
+            while (true) {
+                PipelineBlock* block = popWaiting(*toParser[i], counters.emptyWaits);
+                if (block) {
+                    const char* text = block->text.data();
+                    parseRows(text, text + block->text.size(), plan, block->rows.dateTree, block->rows.dataMap);
+                    std::string().swap(block->text);
+                    counters.blocks++;
+                }
+                pushWaiting(*toIndexer[i], block, counters.fullWaits);
+                if (!block) return;
+            }
+        }));
+    }
+
+    //rows are collected in a shard first so a file that can not be read to the end adds nothing
+    LoadShard shard;
+    for (int turn = 0;; turn = (turn + 1) % parsers) {
+        PipelineBlock* block = popWaiting(*toIndexer[turn], indexerCounters.emptyWaits);
+        if (!block) break;
+        mergeShard(block->rows, shard.dateTree, shard.dataMap);
+        delete block;
+        indexerCounters.blocks++;
+    }
+    reader.join();
+    //the other parsers' end markers are still on their way
+    for (int i = 0; i < parsers; i++) {
+        workers[i]->join();
+        delete workers[i];
+        PipelineBlock* rest;
+        while (toIndexer[i]->tryPop(rest)) delete rest;
+        delete toParser[i];
+        delete toIndexer[i];
+    }
+
+    PipelineStats fileStats;
+    fileStats.reader = readerCounters;
+    for (int i = 0; i < parsers; i++) fileStats.parsers.add(parserCounters[i]);
+    fileStats.indexer = indexerCounters;
+    fileStats.parserCount = parsers;
+    stats.add(fileStats);
+    if (readFailed) {
+        reportError(message, filename);
+        return false;
+    }
+    mergeShard(shard, dateTree, dataMap);
+    if (cut) *wholeLines = source.GetHandedOut();
+    return true;
+}
+
+//one line per stage: what it did and how often it waited on its neighbours
+void FileHandler::printPipelineStats(std::ostream& os, const PipelineStats& stats) {
+    os << "Pipeline reader:  " << stats.reader.blocks << " blocks, waited "
+       << stats.reader.fullWaits << " times for the parsers" << std::endl;
+    os << "Pipeline parsers: " << stats.parsers.blocks << " blocks on " << stats.parserCount
+       << (stats.parserCount == 1 ? " worker" : " workers") << ", waited "
+       << stats.parsers.emptyWaits << " times for the reader and " << stats.parsers.fullWaits
+       << " times for the indexer" << std::endl;
+    os << "Pipeline indexer: " << stats.indexer.blocks << " blocks, waited "
+       << stats.indexer.emptyWaits << " times for the parsers" << std::endl;
+}
+
+//parses every row between begin and end (begin at the start of a line)
+void FileHandler::parseRows(const char* begin, const char* end, const ParsePlan& plan,
+                            BST<int>& dateTree, MonthTable<WeatherLog>& dataMap) {
+    const char* p = begin;
+    const char* eol;
+    float extras[FIELD_COUNT];
+    FieldSet extraFields = plan.GetExtraFields();
+    WeatherLog* log = NULL;
+    int monthStart = 0, monthEnd = 0; //epoch minute range of the month log holds
+    while (p < end) {
+        eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        WeatherEntry w;
+        if (plan.parseRow(p, eol, w, extras)) {
+            //consecutive rows share a month, only work the month out when a row leaves it
+            if (!log || w.minutes < monthStart || w.minutes >= monthEnd) {
+                int year, month, day;
+                civilFromDays(dayOfMinutes(w.minutes), year, month, day);
+                monthStart = daysFromCivil(year, month, 1) * 1440;
+                monthEnd = monthStart + daysInMonth(year, month) * 1440;
+                int key = monthKey(year, month);
+                log = &dataMap[key];
+                dateTree.insert(key);
+            }
+            if (extraFields) log->pushBack(w, extras, extraFields);
+            else log->pushBack(w);
+        }
+        p = eol + 1;
+    }
+}
+
+//parses one CSV file line by line with getline, populates BST and map (the original loader)
+bool FileHandler::parseCSVStream(const std::string& filename, BST<int>& dateTree, MonthTable<WeatherLog>& dataMap) {
     std::ifstream file(filename);
     if(!file.is_open()) {
         std::cerr << "Could not open: " << filename << std::endl;
@@ -139,7 +712,7 @@ std::map<std::string, int> FileHandler::buildColumnMap(const std::string& header
 
 //process one CSV line for weather data
 void FileHandler::processCSVLine(const std::string& line, const std::map<std::string, int>& colMap,
-                                 BST<std::string>& dateTree, std::map<std::string, WeatherLog>& dataMap) {
+                                 BST<int>& dateTree, MonthTable<WeatherLog>& dataMap) {
     std::stringstream ss(line);
     std::string cell;
     Vector<std::string> fields;
@@ -164,14 +737,15 @@ void FileHandler::processCSVLine(const std::string& line, const std::map<std::st
         float temp = fields[colMap.at("T")].empty() ? NAN : std::stof(fields[colMap.at("T")]);
         float solar = fields[colMap.at("SR")].empty() ? NAN : std::stof(fields[colMap.at("SR")]);
 
-        WeatherEntry w {date, time, wind, temp, solar};
-        //key is year month as string
-        std::string key = std::to_string(date.GetYear()) + "-" + (date.GetMonth() < 10 ? "0" : "") + std::to_string(date.GetMonth());
+        //the packed timestamp only holds real calendar dates
+        if (!isStampDate(date.GetYear(), date.GetMonth(), date.GetDay())) return;
+
+        WeatherEntry w {toEpochMinutes(date, time), wind, temp, solar};
+        //key is the month number year*12 + month-1
+        int key = monthKey(date.GetYear(), date.GetMonth());
 
         dataMap[key].pushBack(w);
-        if (!dateTree.search(key)) {
-            dateTree.insert(key);
-        }
+        dateTree.insert(key);
     } catch (...) {
         //skip any problematic lines
     }
@@ -0,0 +1,448 @@
+#include "LazyLoader.h"
+#include "CompressedReader.h"
+#include "FastParse.h"
+#include "Parallel.h"
+#include "Timestamp.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+//rows of a file sampled before it is trusted to be in time order
+const int ORDER_SAMPLES = 256;
+
+//month key of an epoch minute
+int keyOfMinutes(int minutes) {
+    int year, month, day;
+    civilFromDays(dayOfMinutes(minutes), year, month, day);
+    return monthKey(year, month);
+}
+
+//month key of the row starting at p; next is set to the start of the row after it
+bool rowKey(const char* p, const char* end, int wast, int& key, const char*& next) {
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!eol) eol = end;
+    next = (eol == end) ? end : eol + 1;
+    //the date is everything up to the first space of the WAST cell
+    const char* cell = p;
+    for (int c = 0; c < wast && cell != eol; c++) {
+        while (cell != eol && *cell != ',') ++cell;
+        if (cell != eol) ++cell;
+    }
+    const char* dateEnd = cell;
+    while (dateEnd != eol && *dateEnd != ' ' && *dateEnd != ',') ++dateEnd;
+    int year, month, day;
+    if (scanDate(cell, dateEnd, year, month, day) != PARSE_OK) return false;
+    key = monthKey(year, month);
+    return true;
+}
+
+//moves p to the first row with a valid date that starts before limit, false if there is none
+bool firstDatedRow(const char*& p, const char* limit, const char* end, int wast, int& key, const char*& next) {
+    for (; p < limit; p = next) {
+        if (rowKey(p, end, wast, key, next)) return true;
+    }
+    return false;
+}
+
+//start of the first row at or after a byte
+const char* rowStartAt(const char* at, const char* body, const char* end) {
+    if (at <= body) return body;
+    if (at[-1] == '\n') return at;
+    const char* eol = static_cast<const char*>(std::memchr(at, '\n', end - at));
+    return eol ? eol + 1 : end;
+}
+
+//reads the date of every row, consecutive rows of one month become one range
+void scanRows(const char* begin, const char* body, const char* end, int wast, Vector<int>& keys,
+              Vector<LazyRange>& found) {
+    int key = -1;
+    LazyRange range = {0, 0, 0, -1};
+    const char* next;
+    for (const char* p = body; p < end; p = next) {
+        int rowMonth;
+        //rows without a valid date are never loaded; inside a range they are skipped when it is parsed
+        if (!rowKey(p, end, wast, rowMonth, next)) continue;
+        if (rowMonth == key) {
+            range.end = next - begin;
+            continue;
+        }
+        if (key >= 0) {
+            keys.pushBack(key);
+            found.pushBack(range);
+        }
+        key = rowMonth;
+        range.begin = p - begin;
+        range.end = next - begin;
+    }
+    if (key >= 0) {
+        keys.pushBack(key);
+        found.pushBack(range);
+    }
+}
+
+//first row start in [lo, hi] from which on the dated rows are of month key or later, for rows in time order
+const char* firstRowOfKey(const char* lo, const char* hi, const char* body, const char* end, int wast, int key) {
+    while (lo < hi) {
+        const char* q = rowStartAt(lo + (hi - lo) / 2, body, end);
+        if (q >= hi) q = lo;
+        const char* row = q;
+        const char* next;
+        int rowMonth;
+        if (!firstDatedRow(row, hi, end, wast, rowMonth, next) || rowMonth >= key) hi = q;
+        else lo = next;
+    }
+    return lo;
+}
+
+//samples the file, and if the months never go back finds where each one starts by binary search.
+//returns false (with keys and found partly filled) if the rows are not in time order
+bool searchRows(const char* begin, const char* body, const char* end, int wast, Vector<int>& keys,
+                Vector<LazyRange>& found) {
+    int previous = INT_MIN;
+    for (int i = 0; i < ORDER_SAMPLES; i++) {
+        const char* row = rowStartAt(body + (end - body) * i / ORDER_SAMPLES, body, end);
+        const char* next;
+        int rowMonth;
+        if (!firstDatedRow(row, end, end, wast, rowMonth, next)) break;
+        if (rowMonth < previous) return false;
+        previous = rowMonth;
+    }
+
+    const char* from = body;
+    const char* next;
+    int key;
+    if (!firstDatedRow(from, end, end, wast, key, next)) return true;
+    for (;;) {
+        const char* bound = firstRowOfKey(next, end, body, end, wast, key + 1);
+        LazyRange range = {0, from - begin, bound - begin, -1};
+        keys.pushBack(key);
+        found.pushBack(range);
+        from = bound;
+        int nextKey;
+        if (!firstDatedRow(from, end, end, wast, nextKey, next)) return true;
+        //an earlier month after this one, the samples missed it
+        if (nextKey <= key) return false;
+        key = nextKey;
+    }
+}
+
+//tells whether a month has a range in a source
+bool hasSource(const LazyMonth* month, int source) {
+    if (!month) return false;
+    for (int r = 0; r < month->ranges.GetSize(); r++) {
+        if (month->ranges[r].source == source) return true;
+    }
+    return false;
+}
+
+}
+
+LazyLoader::LazyLoader()
+    : tree(NULL), data(NULL), monthIndex(NULL), rangeIndex(NULL), pendingCount(0), rangesStale(false) {}
+
+//index every listed file (one worker per file), then merge the ranges in list order
+bool LazyLoader::open(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap, MonthIndex& index,
+                      RangeIndex& ranges, const LoadOptions& options) {
+    Vector<std::string> files;
+    if (!FileHandler::readSourceList("data/data_source.txt", files)) {
+        std::cerr << "Could not open data_source.txt" << std::endl;
+        return false;
+    }
+    int count = files.GetSize();
+    Vector<LazySource> found(count, LazySource());
+    Vector<Vector<int> > keys(count, Vector<int>());
+    Vector<Vector<LazyRange> > spans(count, Vector<LazyRange>());
+    Vector<std::string> errors(count, std::string());
+    for (int i = 0; i < count; i++) {
+        found[i].path = "data/" + files[i];
+        found[i].compressed = compressionOf(found[i].path) != COMPRESSION_NONE;
+    }
+    parallelFor(count, resolveThreadCount(options.threads), [&](int i) {
+        if (!found[i].compressed) indexFile(found[i], options.fields, keys[i], spans[i], errors[i]);
+    });
+
+    tree = &dateTree;
+    data = &dataMap;
+    monthIndex = &index;
+    rangeIndex = &ranges;
+    sources.Clear();
+    months.Clear();
+    pendingCount = 0;
+    for (int i = 0; i < count; i++) {
+        //messages are printed here, in list order, rather than by the workers
+        if (!errors[i].empty()) {
+            std::cerr << errors[i] << std::endl;
+            continue;
+        }
+        if (found[i].compressed) {
+            //parsed here rather than by the workers, so its messages stay in list order too
+            LoadShard shard;
+            if (!FileHandler::parseCSV(found[i].path, shard.dateTree, shard.dataMap,
+                                       resolveThreadCount(options.threads), options.fields)) continue;
+            std::cerr << "Compressed file parsed in full (lazy loading needs byte offsets): " << found[i].path
+                      << std::endl;
+            found[i].rows = std::move(shard.dataMap);
+            LazyRange whole = {0, 0, 0, -1};
+            found[i].rows.forEach([&](int key, const WeatherLog& log) {
+                if (log.GetSize() == 0) return;
+                keys[i].pushBack(key);
+                spans[i].pushBack(whole);
+            });
+        }
+        int source = sources.GetSize();
+        sources.pushBack(std::move(found[i]));
+        for (int r = 0; r < spans[i].GetSize(); r++) {
+            LazyRange range = spans[i][r];
+            range.source = source;
+            LazyMonth& month = months[keys[i][r]];
+            if (month.ranges.GetSize() == 0) {
+                pendingCount++;
+                dateTree.insert(keys[i][r]);
+            }
+            month.ranges.pushBack(range);
+        }
+    }
+    return sources.GetSize() > 0;
+}
+
+bool LazyLoader::IsOpen() const {
+    return sources.GetSize() > 0;
+}
+
+int LazyLoader::GetPendingCount() const {
+    return pendingCount;
+}
+
+//reads the dates of a few rows per month if the file is in time order, of every row otherwise
+bool LazyLoader::indexFile(LazySource& source, FieldSet fields, Vector<int>& keys, Vector<LazyRange>& found,
+                           std::string& error) {
+    MappedFile file;
+    if (!file.open(source.path)) {
+        error = "Could not open: " + source.path;
+        return false;
+    }
+    const char* begin = file.GetData();
+    const char* end = begin + file.GetSize();
+    if (begin == end) {
+        error = "Empty CSV or unreadable: " + source.path;
+        return false;
+    }
+    source.size = static_cast<long long>(end - begin);
+    const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    if (!eol) eol = end;
+    std::map<std::string, int> colMap = FileHandler::buildColumnMap(std::string(begin, eol));
+    //a file without the core columns has no rows to load, like in parseCSV
+    if (!source.plan.build(colMap, fields)) return true;
+    int wast = colMap.find(metFieldName(FIELD_WAST))->second;
+    const char* body = (eol == end) ? end : eol + 1;
+
+    source.searched = searchRows(begin, body, end, wast, keys, found);
+    if (!source.searched) {
+        keys.Clear();
+        found.Clear();
+        scanRows(begin, body, end, wast, keys, found);
+    }
+    return true;
+}
+
+//a compressed file's rows are copied from memory, a plain file's range is parsed on its own to check it
+bool LazyLoader::parseRange(LazyRange& range, int key, MappedFile& file, int& mapped, WeatherLog& log) {
+    LazySource& source = sources[range.source];
+    range.rows = 0;
+    if (source.compressed) {
+        const WeatherLog* rows = source.rows.find(key);
+        if (rows) {
+            range.rows = rows->GetSize();
+            log.append(*rows);
+        }
+        return true;
+    }
+    if (range.source != mapped) {
+        mapped = range.source;
+        if (!file.open(source.path) || static_cast<long long>(file.GetSize()) != source.size) {
+            std::cerr << "File changed since it was indexed: " << source.path << std::endl;
+            file.close();
+        }
+    }
+    if (!file.GetData()) return true;
+    LoadShard part;
+    FileHandler::parseRows(file.GetData() + range.begin, file.GetData() + range.end, source.plan, part.dateTree,
+                           part.dataMap);
+    bool stray = false;
+    part.dataMap.forEach([&](int rowMonth, const WeatherLog& rows) {
+        if (rowMonth != key && rows.GetSize() > 0) stray = true;
+    });
+    if (stray) return false;
+    const WeatherLog* rows = part.dataMap.find(key);
+    if (rows) {
+        range.rows = rows->GetSize();
+        log.append(*rows);
+    }
+    return true;
+}
+
+//indexes the file again row by row and puts the months it touches in line with the new ranges
+void LazyLoader::rescan(int source) {
+    LazySource& file = sources[source];
+    file.searched = false;
+    Vector<int> keys;
+    Vector<LazyRange> found;
+    MappedFile text;
+    if (text.open(file.path) && static_cast<long long>(text.GetSize()) == file.size) {
+        const char* begin = text.GetData();
+        const char* end = begin + text.GetSize();
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (!eol) eol = end;
+        std::map<std::string, int> colMap = FileHandler::buildColumnMap(std::string(begin, eol));
+        int wast = colMap.find(metFieldName(FIELD_WAST))->second;
+        scanRows(begin, (eol == end) ? end : eol + 1, end, wast, keys, found);
+    } else {
+        //its months lose the file's rows, as if it had been removed
+        std::cerr << "File changed since it was indexed: " << file.path << std::endl;
+    }
+    text.close();
+    MonthTable<Vector<LazyRange> > fresh;
+    for (int i = 0; i < keys.GetSize(); i++) {
+        found[i].source = source;
+        fresh[keys[i]].pushBack(found[i]);
+    }
+
+    Vector<int> touched;
+    months.forEach([&](int key, const LazyMonth& month) {
+        if (hasSource(&month, source)) touched.pushBack(key);
+    });
+    fresh.forEach([&](int key, const Vector<LazyRange>& added) {
+        if (added.GetSize() > 0 && !hasSource(months.find(key), source)) touched.pushBack(key);
+    });
+
+    MappedFile mappedFile;
+    int mapped = -1;
+    for (int t = 0; t < touched.GetSize(); t++) {
+        int key = touched[t];
+        LazyMonth& month = months[key];
+        const Vector<LazyRange>* added = fresh.find(key);
+        const WeatherLog* old = month.loaded ? data->find(key) : NULL;
+        Vector<LazyRange> merged;
+        WeatherLog log;
+        int at = 0;
+        bool placed = false;
+        //the file's new ranges go where its old ones were in list order
+        auto addFresh = [&]() {
+            if (placed) return;
+            placed = true;
+            if (!added) return;
+            for (int r = 0; r < added->GetSize(); r++) {
+                LazyRange range = (*added)[r];
+                if (month.loaded) parseRange(range, key, mappedFile, mapped, log);
+                merged.pushBack(range);
+            }
+        };
+        for (int r = 0; r < month.ranges.GetSize(); r++) {
+            const LazyRange& range = month.ranges[r];
+            if (range.source == source) {
+                //rows of the old range are replaced by the new ones
+                if (month.loaded) at += range.rows;
+                continue;
+            }
+            if (range.source > source) addFresh();
+            if (month.loaded && old && range.rows > 0) log.append(*old, at, range.rows);
+            if (month.loaded) at += range.rows;
+            merged.pushBack(range);
+        }
+        addFresh();
+
+        bool had = month.ranges.GetSize() > 0;
+        month.ranges = std::move(merged);
+        if (month.loaded) {
+            WeatherLog& rows = (*data)[key];
+            rows = std::move(log);
+            monthIndex->update(key, rows);
+            rangesStale = true;
+        } else if (!had && month.ranges.GetSize() > 0) {
+            pendingCount++;
+            tree->insert(key);
+        } else if (had && month.ranges.GetSize() == 0) {
+            pendingCount--;
+            tree->remove(key);
+        }
+    }
+}
+
+//parses the month's ranges, files in list order and rows in file order like a full load
+bool LazyLoader::loadKey(int key) {
+    LazyMonth* month = months.find(key);
+    if (!month || month->loaded || month->ranges.GetSize() == 0) return false;
+    WeatherLog log;
+    MappedFile file;
+    int mapped = -1;
+    for (int r = 0; r < month->ranges.GetSize(); r++) {
+        LazyRange& range = month->ranges[r];
+        if (parseRange(range, key, file, mapped, log)) continue;
+        int source = range.source;
+        std::cerr << "Rows are not in time order, indexing every row: " << sources[source].path << std::endl;
+        file.close();
+        rescan(source);
+        return loadKey(key);
+    }
+    month->loaded = true;
+    pendingCount--;
+    //a compressed file's copy of the rows is not needed any more
+    for (int r = 0; r < month->ranges.GetSize(); r++) {
+        LazySource& source = sources[month->ranges[r].source];
+        if (source.compressed && source.rows.find(key)) source.rows[key] = WeatherLog();
+    }
+    if (log.GetSize() > 0) {
+        WeatherLog& rows = (*data)[key];
+        rows = std::move(log);
+        monthIndex->update(key, rows);
+    }
+    rangesStale = true;
+    return true;
+}
+
+void LazyLoader::loadMonth(int year, int month) {
+    if (!IsOpen() || month < 1 || month > 12) return;
+    loadKey(monthKey(year, month));
+}
+
+void LazyLoader::loadYear(int year) {
+    if (!IsOpen()) return;
+    for (int month = 1; month <= 12; month++) loadKey(monthKey(year, month));
+}
+
+void LazyLoader::loadMonthFirstYear(int month) {
+    if (!IsOpen() || month < 1 || month > 12) return;
+    for (int key = months.GetFirstKey(); key < months.GetEndKey(); key++) {
+        if (keyMonth(key) != month || !months.find(key)) continue;
+        loadKey(key);
+        const WeatherLog* log = data->find(key);
+        if (log && log->GetSize() > 0) return;
+    }
+}
+
+void LazyLoader::loadRange(int from, int to) {
+    if (!IsOpen()) return;
+    if (from <= to) {
+        int first = keyOfMinutes(from), last = keyOfMinutes(to);
+        if (first < months.GetFirstKey()) first = months.GetFirstKey();
+        if (last >= months.GetEndKey()) last = months.GetEndKey() - 1;
+        for (int key = first; key <= last; key++) loadKey(key);
+    }
+    //months parsed for other queries are not in the range index yet either
+    refreshRanges();
+}
+
+void LazyLoader::loadAll() {
+    if (!IsOpen()) return;
+    for (int key = months.GetFirstKey(); key < months.GetEndKey(); key++) loadKey(key);
+    refreshRanges();
+}
+
+void LazyLoader::refreshRanges() {
+    if (!IsOpen() || !rangesStale) return;
+    rangeIndex->build(*data);
+    rangesStale = false;
+}
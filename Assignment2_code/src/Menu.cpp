@@ -1,23 +1,56 @@
 #include "Menu.h"
+#include "Timestamp.h"
 #include <iomanip>
 #include <cmath>
 
-void Menu::run(BST<std::string>& tree, std::map<std::string, WeatherLog>& dataMap) {
+void Menu::run(MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges) {
+    LazyLoader loaded; //never opened, everything is in dataMap already
+    run(dataMap, index, ranges, loaded);
+}
+
+void Menu::run(MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges, LazyLoader& lazy) {
+    int option = 0;
+    do {
+        std::cout << "\n";
+        printMenu();
+        std::cout << "Enter your choice (1-6): ";
+        std::cin >> option;
+        answer(option, dataMap, index, ranges, lazy);
+    } while(option != 6);
+}
+
+//the version is pinned while the option runs, so one answer never mixes two versions
+void Menu::run(SnapshotStore& store) {
+    SnapshotStore::Reader reader(store);
+    LazyLoader loaded; //never opened, every version is complete
+    long long seen = store.GetVersion();
     int option = 0;
     do {
         std::cout << "\n";
         printMenu();
-        std::cout << "Enter your choice (1-5): ";
+        std::cout << "Enter your choice (1-6): ";
         std::cin >> option;
-        switch (option) {
-            case 1: showWindStats(tree, dataMap); break;
-            case 2: showTempStats(tree, dataMap); break;
-            case 3: showCorrelations(tree, dataMap); break;
-            case 4: handleWriteToFile(tree, dataMap); break;
-            case 5: std::cout << "Exiting the program.\n"; break;
-            default: std::cout << "Invalid choice.\n";
+        const DataSnapshot& data = reader.acquire();
+        if (data.version != seen) {
+            std::cout << "Data updated, " << data.readings << " readings loaded\n";
+            seen = data.version;
         }
-    } while(option != 5);
+        answer(option, data.dataMap, data.monthIndex, data.rangeIndex, loaded);
+        reader.release();
+    } while(option != 6);
+}
+
+void Menu::answer(int option, const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const RangeIndex& ranges,
+                  LazyLoader& lazy) {
+    switch (option) {
+        case 1: showWindStats(index, lazy); break;
+        case 2: showTempStats(index, lazy); break;
+        case 3: showCorrelations(index, lazy); break;
+        case 4: handleWriteToFile(dataMap, index, lazy); break;
+        case 5: showRangeStats(ranges, lazy); break;
+        case 6: std::cout << "Exiting the program.\n"; break;
+        default: std::cout << "Invalid choice.\n";
+    }
 }
 
 void Menu::printMenu() {
@@ -26,11 +59,12 @@ void Menu::printMenu() {
     std::cout << "2. Calculate average temperature and std dev for each month in year\n";
     std::cout << "3. Calculate sPCC for (S_T, S_R, T_R) for a selected month for all years.\n";
     std::cout << "4. Write all stats to file\n";
-    std::cout << "5. Exit the program.\n";
+    std::cout << "5. Calculate stats for a time range (start and end date/time)\n";
+    std::cout << "6. Exit the program.\n";
 }
 
-bool Menu::hasData(const WeatherLog& records, int month, int year, int opt) {
-    if(records.GetSize() == 0) {
+bool Menu::hasData(const MonthStats* stats, int month, int year, int opt) {
+    if(stats == NULL || stats->rows == 0) {
         if(opt == 1) std::cout << monthName(month) << " " << year << ": No Data\n";
         else std::cout << monthName(month) << ": No Data\n";
         return false;
@@ -46,38 +80,40 @@ std::string Menu::monthName(int month) {
     return (month >= 1 && month <= 12) ? names[month-1] : "Invalid";
 }
 
-void Menu::showWindStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap) {
+void Menu::showWindStats(const MonthIndex& index, LazyLoader& lazy) {
     int year = FileHandler::promptYear();
     int month = FileHandler::promptMonth();
-    WeatherLog data = getRecordsByYearMonth(tree, dataMap, year, month);
-    if(!hasData(data, month, year, 1)) return;
+    lazy.loadMonth(year, month);
+    const MonthStats* stats = index.find(year, month);
+    if(!hasData(stats, month, year, 1)) return;
 
-    Vector<float> speeds = extractWindSpeeds(data);
-    float avg = mean(speeds)*3.6f;
-    float sd = stdev(speeds)*3.6f;
+    MeanVarAcc speeds = MeanVarAcc::fromSums(stats->wind);
+    float avg = speeds.getMean()*3.6f;
+    float sd = speeds.getStdev()*3.6f;
     std::cout << monthName(month) << " " << year << ": "
               << "Average wind speed: " << std::fixed << std::setprecision(1) << avg
               << " km/h, Std dev: " << sd << " km/h\n";
 }
 
-void Menu::showTempStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap) {
+void Menu::showTempStats(const MonthIndex& index, LazyLoader& lazy) {
     int year = FileHandler::promptYear();
+    lazy.loadYear(year);
     std::cout << year << "\n";
     for(int month=1; month<=12; ++month) {
-        WeatherLog data = getRecordsByYearMonth(tree, dataMap, year, month);
-        if(!hasData(data, month, year, 2)) continue;
-        Vector<float> temps = extractTemperatures(data);
-        float avgv = mean(temps);
-        float sdv = stdev(temps);
+        const MonthStats* stats = index.find(year, month);
+        if(!hasData(stats, month, year, 2)) continue;
+        MeanVarAcc temps = MeanVarAcc::fromSums(stats->temp);
+        float avgv = temps.getMean();
+        float sdv = temps.getStdev();
         std::cout << monthName(month) << ": average: "
                   << std::fixed << std::setprecision(1) << avgv
                   << " degree C, std dev: " << sdv << "\n";
     }
 }
 
-void Menu::printCorrelation(const Vector<float>& v1, const Vector<float>& v2, const std::string& lbl) {
+void Menu::printCorrelation(const CoMomentAcc& pairs, const std::string& lbl) {
     try {
-        double value = pearson(v1, v2);
+        double value = pearson(pairs);
         std::cout << lbl << ": ";
         if(std::isnan(value))
             std::cout << "NaN";
@@ -89,88 +125,60 @@ void Menu::printCorrelation(const Vector<float>& v1, const Vector<float>& v2, co
     }
 }
 
-void Menu::showCorrelations(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap) {
+void Menu::showCorrelations(const MonthIndex& index, LazyLoader& lazy) {
     int month = FileHandler::promptMonth();
-    WeatherLog data = getRecordsByMonth(tree, dataMap, month);
-    if(!hasData(data, month, -1, 1)) return;
-
-    //pairwise deletion for S_T, S_R, T_R
-    Vector<float> s_t1, s_t2, s_r1, s_r2, t_r1, t_r2;
-    for(int i=0;i<data.GetSize();i++) {
-        float s = data[i].windSpeed, t = data[i].temperature, r = data[i].solarRadiation;
-        if(!std::isnan(s) && !std::isnan(t))           { s_t1.pushBack(s); s_t2.pushBack(t); }
-        if(!std::isnan(s) && !std::isnan(r) && r>=100) { s_r1.pushBack(s); s_r2.pushBack(r); }
-        if(!std::isnan(t) && !std::isnan(r) && r>=100) { t_r1.pushBack(t); t_r2.pushBack(r); }
-    }
+    lazy.loadMonthFirstYear(month);
+    //the month's readings in the earliest year that has it
+    int year = 0;
+    const MonthStats* stats = index.firstYear(month, year);
+    if(!hasData(stats, month, -1, 1)) return;
 
     std::cout << "Sample Pearson Correlation Coefficients sPCC for " << monthName(month) << ":\n";
-    printCorrelation(s_t1, s_t2, "S_T");
-    printCorrelation(s_r1, s_r2, "S_R");
-    printCorrelation(t_r1, t_r2, "T_R");
+    printCorrelation(CoMomentAcc::fromSums(stats->windTemp), "S_T");
+    printCorrelation(CoMomentAcc::fromSums(stats->windSolar), "S_R");
+    printCorrelation(CoMomentAcc::fromSums(stats->tempSolar), "T_R");
 }
 
-void Menu::writeMonthStats(std::ofstream& file, const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, int year, int month) {
-    WeatherLog data = getRecordsByYearMonth(tree, dataMap, year, month);
-    if(data.GetSize() == 0) return;
-
-    Vector<float> wind = extractWindSpeeds(data), temp = extractTemperatures(data), solar = extractSolarRadiation(data);
-    float wAvg = mean(wind)*3.6f, wStdev = stdev(wind)*3.6f, wMad = 0;
-    float tAvg = mean(temp), tStdev = stdev(temp), tMad = 0;
-    float solarTotal = calculateTotalSolar(solar);
-
-    //compute MAD (Mean Absolute Deviation, 1 decimal) for wind
-    float wMean = mean(wind)*3.6f;
-    int w_n = 0;
-    for(int i=0; i<wind.GetSize(); i++) {
-        if(!std::isnan(wind[i])) { wMad += std::abs(wind[i]*3.6f - wMean); w_n++; }
-    }
-    if(w_n>0) wMad /= w_n;
-
-    //compute MAD for temp
-    float tMean = mean(temp);
-    int t_n = 0;
-    for(int i=0; i<temp.GetSize(); i++) {
-        if(!std::isnan(temp[i])) { tMad += std::abs(temp[i] - tMean); t_n++; }
+void Menu::showRangeStats(const RangeIndex& ranges, LazyLoader& lazy) {
+    Date fromDate, toDate;
+    MyTime fromTime, toTime;
+    FileHandler::promptDateTime("start", fromDate, fromTime);
+    FileHandler::promptDateTime("end", toDate, toTime);
+    int from = toEpochMinutes(fromDate, fromTime), to = toEpochMinutes(toDate, toTime);
+    lazy.loadRange(from, to);
+    MonthStats stats = ranges.query(from, to);
+
+    FileHandler::printDate(std::cout, fromDate) << " ";
+    FileHandler::printTime(std::cout, fromTime) << " to ";
+    FileHandler::printDate(std::cout, toDate) << " ";
+    FileHandler::printTime(std::cout, toTime);
+    if(stats.rows == 0) {
+        std::cout << ": No Data\n";
+        return;
     }
-    if(t_n>0) tMad /= t_n;
-
-    file << monthName(month) << ",";
-    if(!std::isnan(wAvg))
-        file << std::fixed << std::setprecision(1)
-             << wAvg << "(" << wStdev << ", " << wMad << "),";
-    else
-        file << " ,";
-    if(!std::isnan(tAvg))
-        file << std::fixed << std::setprecision(1)
-             << tAvg << "(" << tStdev << ", " << tMad << "),";
-    else
-        file << " ,";
-    if(!std::isnan(solarTotal))
-        file << std::fixed << std::setprecision(1) << solarTotal;
-    else
-        file << " ";
-    file << "\n";
+    std::cout << ": " << stats.rows << " readings\n";
+
+    MeanVarAcc speeds = MeanVarAcc::fromSums(stats.wind), temps = MeanVarAcc::fromSums(stats.temp);
+    std::cout << std::fixed << std::setprecision(1)
+              << "Average wind speed: " << speeds.getMean()*3.6f
+              << " km/h, Std dev: " << speeds.getStdev()*3.6f << " km/h\n"
+              << "Average temperature: " << temps.getMean()
+              << " degree C, std dev: " << temps.getStdev() << "\n"
+              << "Total solar radiation: " << calculateTotalSolar(stats.solar) << " kWh\n";
+    printCorrelation(CoMomentAcc::fromSums(stats.windTemp), "S_T");
+    printCorrelation(CoMomentAcc::fromSums(stats.windSolar), "S_R");
+    printCorrelation(CoMomentAcc::fromSums(stats.tempSolar), "T_R");
 }
 
-void Menu::writeAllStats(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap, const std::string& filename, int year) {
-    std::ofstream file(filename);
-    if(!file) {
-        std::cerr << "Error opening output file: " << filename << std::endl;
-        return;
-    }
-    file << year << "\n";
-    bool any = false;
-    for(int month=1; month<=12; ++month) {
-        if(getRecordsByYearMonth(tree, dataMap, year, month).GetSize()>0) {
-            writeMonthStats(file, tree, dataMap, year, month);
-            any = true;
-        }
-    }
-    if(!any) file << "No Data";
+void Menu::writeAllStats(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, const std::string& filename, int year) {
+    Vector<std::string> text;
+    ReportEngine::buildYears(dataMap, index, year, year, 1, text);
+    ReportEngine::writeFile(filename, text[0]);
 }
 
-void Menu::handleWriteToFile(const BST<std::string>& tree, const std::map<std::string, WeatherLog>& dataMap) {
+void Menu::handleWriteToFile(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, LazyLoader& lazy) {
     int year = FileHandler::promptYear();
-    writeAllStats(tree, dataMap, "WindTempSolar.csv", year);
+    lazy.loadYear(year);
+    writeAllStats(dataMap, index, "WindTempSolar.csv", year);
     std::cout << "Data written to WindTempSolar.csv\n";
 }
@@ -0,0 +1,146 @@
+#include "MonthIndex.h"
+#include <cmath>
+
+namespace {
+
+void addSums(NanSums& to, const NanSums& from) {
+    to.count += from.count;
+    to.sum += from.sum;
+    to.sumSq += from.sumSq;
+}
+
+void addCross(CrossSums& to, const CrossSums& from) {
+    to.count += from.count;
+    to.sumX += from.sumX;
+    to.sumY += from.sumY;
+    to.sumXX += from.sumXX;
+    to.sumYY += from.sumYY;
+    to.sumXY += from.sumXY;
+}
+
+void subSums(NanSums& to, const NanSums& from) {
+    to.count -= from.count;
+    to.sum -= from.sum;
+    to.sumSq -= from.sumSq;
+}
+
+void subCross(CrossSums& to, const CrossSums& from) {
+    to.count -= from.count;
+    to.sumX -= from.sumX;
+    to.sumY -= from.sumY;
+    to.sumXX -= from.sumXX;
+    to.sumYY -= from.sumYY;
+    to.sumXY -= from.sumXY;
+}
+
+void addValue(NanSums& to, double v) {
+    to.count++;
+    to.sum += v;
+    to.sumSq += v * v;
+}
+
+void addPair(CrossSums& to, double x, double y) {
+    to.count++;
+    to.sumX += x;
+    to.sumY += y;
+    to.sumXX += x * x;
+    to.sumYY += y * y;
+    to.sumXY += x * y;
+}
+
+}
+
+MonthStats::MonthStats() : rows(0) {
+    NanSums none = {0, 0.0, 0.0};
+    CrossSums noPairs = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    wind = temp = solar = none;
+    windTemp = windSolar = tempSolar = noPairs;
+}
+
+MonthStats MonthStats::build(const WeatherLog& log) {
+    MonthStats stats;
+    int n = log.GetSize();
+    stats.rows = n;
+    if (n == 0) return stats;
+    const float* w = log.GetWindSpeeds().GetData();
+    const float* t = log.GetTemperatures().GetData();
+    const float* r = log.GetSolarRadiation().GetData();
+    stats.wind = nanSums(w, n);
+    stats.temp = nanSums(t, n);
+    stats.windTemp = nanCrossSums(w, t, n);
+
+    //readings below 100 W/m^2 don't count, so the solar sums are filtered here
+    for (int i = 0; i < n; i++) {
+        if (std::isnan(r[i]) || r[i] < 100) continue;
+        addValue(stats.solar, r[i]);
+        if (!std::isnan(w[i])) addPair(stats.windSolar, w[i], r[i]);
+        if (!std::isnan(t[i])) addPair(stats.tempSolar, t[i], r[i]);
+    }
+    return stats;
+}
+
+void MonthStats::add(float w, float t, float r) {
+    rows++;
+    if (!std::isnan(w)) addValue(wind, w);
+    if (!std::isnan(t)) addValue(temp, t);
+    if (!std::isnan(w) && !std::isnan(t)) addPair(windTemp, w, t);
+    if (std::isnan(r) || r < 100) return;
+    addValue(solar, r);
+    if (!std::isnan(w)) addPair(windSolar, w, r);
+    if (!std::isnan(t)) addPair(tempSolar, t, r);
+}
+
+void MonthStats::merge(const MonthStats& other) {
+    rows += other.rows;
+    addSums(wind, other.wind);
+    addSums(temp, other.temp);
+    addSums(solar, other.solar);
+    addCross(windTemp, other.windTemp);
+    addCross(windSolar, other.windSolar);
+    addCross(tempSolar, other.tempSolar);
+}
+
+void MonthStats::remove(const MonthStats& other) {
+    rows -= other.rows;
+    subSums(wind, other.wind);
+    subSums(temp, other.temp);
+    subSums(solar, other.solar);
+    subCross(windTemp, other.windTemp);
+    subCross(windSolar, other.windSolar);
+    subCross(tempSolar, other.tempSolar);
+}
+
+MonthIndex::MonthIndex() {}
+
+void MonthIndex::build(const MonthTable<WeatherLog>& dataMap) {
+    months.Clear();
+    dataMap.forEach([this](int key, const WeatherLog& log) {
+        months[key] = MonthStats::build(log);
+    });
+}
+
+void MonthIndex::update(int key, const WeatherLog& log) {
+    months[key] = MonthStats::build(log);
+}
+
+void MonthIndex::add(int key, const WeatherLog& rows) {
+    months[key].merge(MonthStats::build(rows));
+}
+
+const MonthStats* MonthIndex::find(int year, int month) const {
+    if (month < 1 || month > 12) return NULL;
+    const MonthStats* stats = months.find(monthKey(year, month));
+    return stats && stats->rows > 0 ? stats : NULL;
+}
+
+const MonthStats* MonthIndex::firstYear(int month, int& year) const {
+    if (month < 1 || month > 12 || months.GetCount() == 0) return NULL;
+    for (int y = keyYear(months.GetFirstKey()); monthKey(y, month) < months.GetEndKey(); y++) {
+        const MonthStats* stats = find(y, month);
+        if (stats) {
+            year = y;
+            return stats;
+        }
+    }
+    return NULL;
+}
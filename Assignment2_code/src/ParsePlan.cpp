@@ -0,0 +1,82 @@
+#include "ParsePlan.h"
+#include "FastParse.h"
+#include <cmath>
+
+const unsigned char ParsePlan::SKIP;
+
+ParsePlan::ParsePlan() : lastCore(-1), extraFields(0) {}
+
+//one step per column up to the last wanted one, everything else is skipped
+bool ParsePlan::build(const std::map<std::string, int>& colMap, FieldSet fields) {
+    fields |= CORE_FIELDS;
+    steps.Clear();
+    lastCore = -1;
+    extraFields = fields & ~CORE_FIELDS;
+
+    int last = -1;
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (!(fields & fieldBit(f))) continue;
+        std::map<std::string, int>::const_iterator it = colMap.find(metFieldName(f));
+        if (it == colMap.end()) {
+            //without all four core columns every row would be skipped
+            if (CORE_FIELDS & fieldBit(f)) return false;
+            continue;
+        }
+        if (it->second > last) last = it->second;
+        if ((CORE_FIELDS & fieldBit(f)) && it->second > lastCore) lastCore = it->second;
+    }
+    for (int c = 0; c <= last; c++) steps.pushBack(SKIP);
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (!(fields & fieldBit(f))) continue;
+        std::map<std::string, int>::const_iterator it = colMap.find(metFieldName(f));
+        if (it != colMap.end()) steps[it->second] = static_cast<unsigned char>(f);
+    }
+    return true;
+}
+
+//cells are split like splitFields does: an empty cell after a trailing comma does not exist
+bool ParsePlan::parseRow(const char* begin, const char* end, WeatherEntry& entry, float* extras) const {
+    if (extraFields) {
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (extraFields & fieldBit(f)) extras[f] = NAN;
+        }
+    }
+    const char* p = begin;
+    int columns = steps.GetSize();
+    const unsigned char* step = steps.GetData();
+    for (int c = 0; c < columns; c++) {
+        //a short row only loses the extra columns past its end
+        if (p == end) return c > lastCore;
+        const char* cell = p;
+        while (p != end && *p != ',') ++p;
+        const char* cellEnd = p;
+        if (p != end) ++p;
+
+        switch (step[c]) {
+            case SKIP: break;
+            case FIELD_WAST:
+                if (scanTimestamp(cell, cellEnd, entry.minutes) != PARSE_OK) return false;
+                break;
+            case FIELD_S:
+                if (scanDecimal(cell, cellEnd, entry.windSpeed) > PARSE_EMPTY) return false;
+                break;
+            case FIELD_T:
+                if (scanDecimal(cell, cellEnd, entry.temperature) > PARSE_EMPTY) return false;
+                break;
+            case FIELD_SR:
+                if (scanDecimal(cell, cellEnd, entry.solarRadiation) > PARSE_EMPTY) return false;
+                break;
+            default:
+                if (scanDecimal(cell, cellEnd, extras[step[c]]) > PARSE_EMPTY) extras[step[c]] = NAN;
+        }
+    }
+    return true;
+}
+
+FieldSet ParsePlan::GetExtraFields() const {
+    return extraFields;
+}
+
+int ParsePlan::GetColumnCount() const {
+    return steps.GetSize();
+}
@@ -0,0 +1,179 @@
+#include "RangeIndex.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+const int RangeIndex::BLOCK;
+const int RangeIndex::CHUNK;
+
+RangeIndex::RangeIndex() : count(0) {}
+
+void RangeIndex::build(const MonthTable<WeatherLog>& dataMap) {
+    int n = 0;
+    dataMap.forEach([&n](int, const WeatherLog& log) { n += log.GetSize(); });
+
+    //all readings in load order, then sorted by time through a permutation
+    Vector<int> when(n, 0);
+    Vector<float> w(n, 0.0f), t(n, 0.0f), r(n, 0.0f);
+    int row = 0;
+    dataMap.forEach([&](int, const WeatherLog& log) {
+        ColumnView<int> stamps = log.GetTimestamps();
+        ColumnView<float> logWind = log.GetWindSpeeds(), logTemp = log.GetTemperatures();
+        ColumnView<float> logSolar = log.GetSolarRadiation();
+        for (int i = 0; i < log.GetSize(); i++, row++) {
+            when[row] = stamps[i];
+            w[row] = logWind[i];
+            t[row] = logTemp[i];
+            r[row] = logSolar[i];
+        }
+    });
+    Vector<int> order(n, 0);
+    for (int i = 0; i < n; i++) order[i] = i;
+    if (n > 0) {
+        const int* key = &when[0];
+        std::stable_sort(&order[0], &order[0] + n, [key](int a, int b) { return key[a] < key[b]; });
+    }
+
+    chunks = Vector<std::shared_ptr<Chunk> >();
+    chunks.reserve(n / CHUNK + 1);
+    count = 0;
+    MonthStats running;
+    for (int i = 0; i < n; i++) {
+        int src = order[i];
+        pushReading(when[src], w[src], t[src], r[src], running);
+    }
+}
+
+//new readings sorted by time, then running sums continued from the last stored block
+bool RangeIndex::append(const MonthTable<WeatherLog>& added) {
+    Vector<int> when;
+    Vector<float> w, t, r;
+    added.forEach([&](int, const WeatherLog& log) {
+        ColumnView<int> stamps = log.GetTimestamps();
+        ColumnView<float> logWind = log.GetWindSpeeds(), logTemp = log.GetTemperatures();
+        ColumnView<float> logSolar = log.GetSolarRadiation();
+        for (int i = 0; i < log.GetSize(); i++) {
+            when.pushBack(stamps[i]);
+            w.pushBack(logWind[i]);
+            t.pushBack(logTemp[i]);
+            r.pushBack(logSolar[i]);
+        }
+    });
+    int n = when.GetSize();
+    if (n == 0) return true;
+    Vector<int> order(n, 0);
+    for (int i = 0; i < n; i++) order[i] = i;
+    const int* key = &when[0];
+    std::stable_sort(&order[0], &order[0] + n, [key](int a, int b) { return key[a] < key[b]; });
+    if (count > 0 && when[order[0]] < GetLastTime()) return false;
+
+    int stored = count / BLOCK;
+    MonthStats running = sumsBefore(stored);
+    addReadings(running, stored * BLOCK, count);
+    for (int i = 0; i < n; i++) {
+        int src = order[i];
+        pushReading(when[src], w[src], t[src], r[src], running);
+    }
+    return true;
+}
+
+void RangeIndex::pushReading(int when, float w, float t, float r, MonthStats& running) {
+    Chunk& chunk = tail();
+    chunk.times.pushBack(when);
+    chunk.wind.pushBack(w);
+    chunk.temp.pushBack(t);
+    chunk.solar.pushBack(r);
+    running.add(w, t, r);
+    if (++count % BLOCK == 0) chunk.sums.pushBack(running);
+}
+
+//a full chunk is never changed again, so only the last one can need copying
+RangeIndex::Chunk& RangeIndex::tail() {
+    if (count % CHUNK == 0) {
+        std::shared_ptr<Chunk> fresh = std::make_shared<Chunk>();
+        fresh->times.reserve(CHUNK);
+        fresh->wind.reserve(CHUNK);
+        fresh->temp.reserve(CHUNK);
+        fresh->solar.reserve(CHUNK);
+        fresh->sums.reserve(CHUNK / BLOCK);
+        chunks.pushBack(fresh);
+        return *fresh;
+    }
+    std::shared_ptr<Chunk>& last = chunks[chunks.GetSize() - 1];
+    if (last.use_count() > 1) {
+        last = std::make_shared<Chunk>(*last);
+    } else {
+        //a copy dropped on another thread has finished reading before it let go
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *last;
+}
+
+void RangeIndex::addReadings(MonthStats& stats, int first, int last) const {
+    while (first < last) {
+        const Chunk& chunk = *chunks[first / CHUNK];
+        int at = first % CHUNK;
+        int n = std::min(last - first, CHUNK - at);
+        const float* w = chunk.wind.GetData() + at;
+        const float* t = chunk.temp.GetData() + at;
+        const float* r = chunk.solar.GetData() + at;
+        for (int i = 0; i < n; i++) stats.add(w[i], t[i], r[i]);
+        first += n;
+    }
+}
+
+MonthStats RangeIndex::sumsBefore(int block) const {
+    if (block == 0) return MonthStats();
+    const int perChunk = CHUNK / BLOCK;
+    return chunks[(block - 1) / perChunk]->sums[(block - 1) % perChunk];
+}
+
+int RangeIndex::timeAt(int at) const {
+    return chunks[at / CHUNK]->times[at % CHUNK];
+}
+
+int RangeIndex::GetSize() const {
+    return count;
+}
+
+int RangeIndex::GetFirstTime() const {
+    return count > 0 ? timeAt(0) : 0;
+}
+
+int RangeIndex::GetLastTime() const {
+    return count > 0 ? timeAt(count - 1) : 0;
+}
+
+//the chunk holding the reading first, then the reading inside it
+int RangeIndex::lowerBound(int minute) const {
+    int lo = 0, hi = chunks.GetSize();
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        const Vector<int>& times = chunks[mid]->times;
+        if (times[times.GetSize() - 1] < minute) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == chunks.GetSize()) return count;
+    const Vector<int>& times = chunks[lo]->times;
+    const int* first = times.GetData();
+    return lo * CHUNK + static_cast<int>(std::lower_bound(first, first + times.GetSize(), minute) - first);
+}
+
+//whole blocks come from the stored sums, the partly covered ones at the ends are added up
+MonthStats RangeIndex::query(int from, int to) const {
+    MonthStats window;
+    if (to < from || count == 0) return window;
+    int lo = lowerBound(from);
+    //first reading after "to", without overflowing at the largest int
+    int hi = to == INT_MAX ? count : lowerBound(to + 1);
+    int firstBlock = (lo + BLOCK - 1) / BLOCK, lastBlock = hi / BLOCK;
+    if (firstBlock >= lastBlock) {
+        addReadings(window, lo, hi);
+        return window;
+    }
+    window = sumsBefore(lastBlock);
+    window.remove(sumsBefore(firstBlock));
+    addReadings(window, lo, firstBlock * BLOCK);
+    addReadings(window, lastBlock * BLOCK, hi);
+    return window;
+}
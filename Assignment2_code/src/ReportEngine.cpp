@@ -0,0 +1,168 @@
+#include "ReportEngine.h"
+#include "Menu.h"
+#include "Parallel.h"
+#include "Statistics.h"
+#include "DataUtils.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+MonthReport ReportEngine::monthReport(const MonthTable<WeatherLog>& dataMap, const MonthStats& stats,
+                                      int year, int month) {
+    MonthReport report;
+    //mean, std dev and solar total come from the index
+    MeanVarAcc wStats = MeanVarAcc::fromSums(stats.wind), tStats = MeanVarAcc::fromSums(stats.temp);
+    report.windAvg = wStats.getMean()*3.6f;
+    report.windStdev = wStats.getStdev()*3.6f;
+    report.tempAvg = tStats.getMean();
+    report.tempStdev = tStats.getStdev();
+    report.solarTotal = calculateTotalSolar(stats.solar);
+
+    //MAD (Mean Absolute Deviation) needs the rows, only read when the month is reported
+    WeatherLogView data = getRecordsByYearMonth(dataMap, year, month);
+    report.windMad = meanAbsDeviation(extractWindSpeeds(data), report.windAvg, 3.6f);
+    report.tempMad = meanAbsDeviation(extractTemperatures(data), report.tempAvg);
+    return report;
+}
+
+void ReportEngine::formatMonth(std::string& out, const MonthReport& report, int month) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << Menu::monthName(month) << ",";
+    if(!std::isnan(report.windAvg))
+        line << report.windAvg << "(" << report.windStdev << ", " << report.windMad << "),";
+    else
+        line << " ,";
+    if(!std::isnan(report.tempAvg))
+        line << report.tempAvg << "(" << report.tempStdev << ", " << report.tempMad << "),";
+    else
+        line << " ,";
+    if(!std::isnan(report.solarTotal))
+        line << report.solarTotal;
+    else
+        line << " ";
+    line << "\n";
+    out += line.str();
+}
+
+//every month of every year is one work item, each formats its own line
+void ReportEngine::buildYears(const MonthTable<WeatherLog>& dataMap, const MonthIndex& index, int firstYear, int lastYear, int threads, Vector<std::string>& years) {
+    int yearCount = lastYear - firstYear + 1;
+    if (yearCount < 1) return;
+    int count = yearCount * 12;
+    Vector<std::string> lines(count, std::string());
+    parallelFor(count, resolveThreadCount(threads), [&](int i) {
+        int year = firstYear + i / 12, month = i % 12 + 1;
+        const MonthStats* stats = index.find(year, month);
+        if (stats != NULL) formatMonth(lines[i], monthReport(dataMap, *stats, year, month), month);
+    });
+
+    for (int y = 0; y < yearCount; y++) {
+        std::string text = std::to_string(firstYear + y) + "\n";
+        std::size_t header = text.size();
+        for (int month = 0; month < 12; month++) text += lines[y * 12 + month];
+        if (text.size() == header) text += "No Data";
+        years.pushBack(text);
+    }
+}
+
+bool ReportEngine::write(const BST<int>& tree, const MonthTable<WeatherLog>& dataMap, const MonthIndex& index,
+                         LazyLoader& lazy, const ReportOptions& options) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int firstYear = options.firstYear, lastYear = options.lastYear;
+    bool allYears = firstYear == 0 && lastYear == 0;
+    if (allYears) {
+        if (tree.begin() == tree.end()) {
+            std::cerr << "No data to report" << std::endl;
+            return false;
+        }
+        //the tree keeps the month keys in order, so the years of the first and last one are the bounds
+        firstYear = keyYear(*tree.begin());
+        lastYear = keyYear(*tree.last());
+    }
+    Vector<bool> hasKeys(lastYear - firstYear + 1, false);
+    for (BST<int>::const_iterator it = tree.lowerBound(monthKey(firstYear, 1)); it != tree.end() && keyYear(*it) <= lastYear; ++it)
+        hasKeys[keyYear(*it) - firstYear] = true;
+
+    //loading is not thread safe, so it is done here before the parallel part
+    for (int year = firstYear; year <= lastYear; year++) {
+        if (hasKeys[year - firstYear]) lazy.loadYear(year);
+    }
+    Vector<std::string> years;
+    buildYears(dataMap, index, firstYear, lastYear, options.threads, years);
+
+    bool ok = true;
+    int files = 0, written = 0;
+    std::string combined;
+    for (int y = 0; y < years.GetSize(); y++) {
+        int year = firstYear + y;
+        //with all years, the gaps between the years with data are left out
+        if (allYears && !hasKeys[y]) continue;
+        written++;
+        if (!options.perYear) {
+            combined += years[y];
+            if (combined[combined.size() - 1] != '\n') combined += "\n";
+            continue;
+        }
+        std::string filename = yearFileName(options.filename, year);
+        if (!writeFile(filename, years[y])) {
+            ok = false;
+            continue;
+        }
+        std::cerr << "Data written to " << filename << std::endl;
+        files++;
+    }
+    if (!options.perYear) {
+        if (writeFile(options.filename, combined)) {
+            std::cerr << "Data written to " << options.filename << std::endl;
+            files++;
+        } else {
+            ok = false;
+        }
+    }
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    std::cerr << "Report: " << written << (written == 1 ? " year" : " years") << " in " << files
+              << (files == 1 ? " file" : " files") << ", " << std::fixed << std::setprecision(1)
+              << took.count() * 1000 << " ms on " << resolveThreadCount(options.threads) << " thread(s)" << std::endl;
+    return ok;
+}
+
+std::string ReportEngine::yearFileName(const std::string& filename, int year) {
+    std::size_t dot = filename.rfind('.');
+    std::size_t slash = filename.find_last_of("/\\");
+    //a dot in a directory name is not an extension
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = filename.size();
+    return filename.substr(0, dot) + "_" + std::to_string(year) + filename.substr(dot);
+}
+
+bool ReportEngine::parseYears(const std::string& text, ReportOptions& options) {
+    if (text == "all") {
+        options.firstYear = options.lastYear = 0;
+        return true;
+    }
+    int first = 0, last = 0;
+    char dash = 0, extra = 0;
+    int fields = std::sscanf(text.c_str(), "%d%c%d%c", &first, &dash, &last, &extra);
+    if (fields == 1) last = first;
+    else if (fields != 3 || dash != '-') return false;
+    if (first < 1800 || last > 2100 || first > last) return false;
+    options.firstYear = first;
+    options.lastYear = last;
+    return true;
+}
+
+//the text is put together first, so the file gets one write instead of a stream flush per line
+bool ReportEngine::writeFile(const std::string& filename, const std::string& text) {
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == NULL) {
+        std::cerr << "Error opening output file: " << filename << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0) ok = false;
+    if (!ok) std::cerr << "Error writing output file: " << filename << std::endl;
+    return ok;
+}
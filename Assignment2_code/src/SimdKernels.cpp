@@ -0,0 +1,300 @@
+#include "SimdKernels.h"
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define WEATHER_SIMD_X86 1
+//gcc 12 warns about the self-initialised "undefined" vectors inside its own avx512 headers
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+namespace {
+
+//scalar tails and fallback, shared by all levels
+
+void scalarSums(const float* data, int begin, int n, NanSums& out) {
+    for (int i = begin; i < n; i++) {
+        double v = data[i];
+        if (v != v) continue; //NaN
+        out.count++;
+        out.sum += v;
+        out.sumSq += v * v;
+    }
+}
+
+void scalarCross(const float* x, const float* y, int begin, int n, CrossSums& out) {
+    for (int i = begin; i < n; i++) {
+        double xv = x[i], yv = y[i];
+        if (xv != xv || yv != yv) continue;
+        out.count++;
+        out.sumX += xv;
+        out.sumY += yv;
+        out.sumXX += xv * xv;
+        out.sumYY += yv * yv;
+        out.sumXY += xv * yv;
+    }
+}
+
+NanSums emptySums() {
+    NanSums s = {0, 0.0, 0.0};
+    return s;
+}
+
+CrossSums emptyCross() {
+    CrossSums c = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    return c;
+}
+
+NanSums sumsScalar(const float* data, int n) {
+    NanSums out = emptySums();
+    scalarSums(data, 0, n, out);
+    return out;
+}
+
+CrossSums crossScalar(const float* x, const float* y, int n) {
+    CrossSums out = emptyCross();
+    scalarCross(x, y, 0, n, out);
+    return out;
+}
+
+#ifdef WEATHER_SIMD_X86
+
+//SSE2: 4 floats per step, widened to two pairs of doubles
+
+__attribute__((target("sse2")))
+double hsum128(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("sse2")))
+NanSums sumsSse2(const float* data, int n) {
+    __m128d sum = _mm_setzero_pd(), sq = _mm_setzero_pd();
+    long long count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        __m128 ok = _mm_cmpord_ps(v, v);
+        v = _mm_and_ps(v, ok);
+        count += __builtin_popcount(_mm_movemask_ps(ok));
+        __m128d lo = _mm_cvtps_pd(v), hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        sum = _mm_add_pd(sum, _mm_add_pd(lo, hi));
+        sq = _mm_add_pd(sq, _mm_add_pd(_mm_mul_pd(lo, lo), _mm_mul_pd(hi, hi)));
+    }
+    NanSums out = {count, hsum128(sum), hsum128(sq)};
+    scalarSums(data, i, n, out);
+    return out;
+}
+
+__attribute__((target("sse2")))
+CrossSums crossSse2(const float* x, const float* y, int n) {
+    __m128d sx = _mm_setzero_pd(), sy = _mm_setzero_pd(), sxx = _mm_setzero_pd(),
+            syy = _mm_setzero_pd(), sxy = _mm_setzero_pd();
+    long long count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 xv = _mm_loadu_ps(x + i), yv = _mm_loadu_ps(y + i);
+        __m128 ok = _mm_and_ps(_mm_cmpord_ps(xv, xv), _mm_cmpord_ps(yv, yv));
+        xv = _mm_and_ps(xv, ok);
+        yv = _mm_and_ps(yv, ok);
+        count += __builtin_popcount(_mm_movemask_ps(ok));
+        __m128d xlo = _mm_cvtps_pd(xv), xhi = _mm_cvtps_pd(_mm_movehl_ps(xv, xv));
+        __m128d ylo = _mm_cvtps_pd(yv), yhi = _mm_cvtps_pd(_mm_movehl_ps(yv, yv));
+        sx = _mm_add_pd(sx, _mm_add_pd(xlo, xhi));
+        sy = _mm_add_pd(sy, _mm_add_pd(ylo, yhi));
+        sxx = _mm_add_pd(sxx, _mm_add_pd(_mm_mul_pd(xlo, xlo), _mm_mul_pd(xhi, xhi)));
+        syy = _mm_add_pd(syy, _mm_add_pd(_mm_mul_pd(ylo, ylo), _mm_mul_pd(yhi, yhi)));
+        sxy = _mm_add_pd(sxy, _mm_add_pd(_mm_mul_pd(xlo, ylo), _mm_mul_pd(xhi, yhi)));
+    }
+    CrossSums out = {count, hsum128(sx), hsum128(sy), hsum128(sxx), hsum128(syy), hsum128(sxy)};
+    scalarCross(x, y, i, n, out);
+    return out;
+}
+
+//AVX2: 8 floats per step, widened to two vectors of 4 doubles
+
+__attribute__((target("avx2")))
+double hsum256(__m256d v) {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2")))
+NanSums sumsAvx2(const float* data, int n) {
+    __m256d sum = _mm256_setzero_pd(), sq = _mm256_setzero_pd();
+    long long count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        __m256 ok = _mm256_cmp_ps(v, v, _CMP_ORD_Q);
+        v = _mm256_and_ps(v, ok);
+        count += __builtin_popcount(_mm256_movemask_ps(ok));
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        sum = _mm256_add_pd(sum, _mm256_add_pd(lo, hi));
+        sq = _mm256_add_pd(sq, _mm256_add_pd(_mm256_mul_pd(lo, lo), _mm256_mul_pd(hi, hi)));
+    }
+    NanSums out = {count, hsum256(sum), hsum256(sq)};
+    scalarSums(data, i, n, out);
+    return out;
+}
+
+__attribute__((target("avx2")))
+CrossSums crossAvx2(const float* x, const float* y, int n) {
+    __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), sxx = _mm256_setzero_pd(),
+            syy = _mm256_setzero_pd(), sxy = _mm256_setzero_pd();
+    long long count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 xv = _mm256_loadu_ps(x + i), yv = _mm256_loadu_ps(y + i);
+        __m256 ok = _mm256_and_ps(_mm256_cmp_ps(xv, xv, _CMP_ORD_Q), _mm256_cmp_ps(yv, yv, _CMP_ORD_Q));
+        xv = _mm256_and_ps(xv, ok);
+        yv = _mm256_and_ps(yv, ok);
+        count += __builtin_popcount(_mm256_movemask_ps(ok));
+        __m256d xlo = _mm256_cvtps_pd(_mm256_castps256_ps128(xv)), xhi = _mm256_cvtps_pd(_mm256_extractf128_ps(xv, 1));
+        __m256d ylo = _mm256_cvtps_pd(_mm256_castps256_ps128(yv)), yhi = _mm256_cvtps_pd(_mm256_extractf128_ps(yv, 1));
+        sx = _mm256_add_pd(sx, _mm256_add_pd(xlo, xhi));
+        sy = _mm256_add_pd(sy, _mm256_add_pd(ylo, yhi));
+        sxx = _mm256_add_pd(sxx, _mm256_add_pd(_mm256_mul_pd(xlo, xlo), _mm256_mul_pd(xhi, xhi)));
+        syy = _mm256_add_pd(syy, _mm256_add_pd(_mm256_mul_pd(ylo, ylo), _mm256_mul_pd(yhi, yhi)));
+        sxy = _mm256_add_pd(sxy, _mm256_add_pd(_mm256_mul_pd(xlo, ylo), _mm256_mul_pd(xhi, yhi)));
+    }
+    CrossSums out = {count, hsum256(sx), hsum256(sy), hsum256(sxx), hsum256(syy), hsum256(sxy)};
+    scalarCross(x, y, i, n, out);
+    return out;
+}
+
+//AVX-512: 16 floats per step, the tail is done with a masked load
+
+__attribute__((target("avx512f")))
+__m512d lowDoubles(__m512 v) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+}
+
+__attribute__((target("avx512f")))
+__m512d highDoubles(__m512 v) {
+    return _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+}
+
+__attribute__((target("avx512f")))
+NanSums sumsAvx512(const float* data, int n) {
+    __m512d sum = _mm512_setzero_pd(), sq = _mm512_setzero_pd();
+    long long count = 0;
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 live = (n - i >= 16) ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 v = _mm512_maskz_loadu_ps(live, data + i);
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(live, v, v, _CMP_ORD_Q);
+        v = _mm512_maskz_mov_ps(ok, v);
+        count += __builtin_popcount(ok);
+        __m512d lo = lowDoubles(v), hi = highDoubles(v);
+        sum = _mm512_add_pd(sum, _mm512_add_pd(lo, hi));
+        sq = _mm512_add_pd(sq, _mm512_add_pd(_mm512_mul_pd(lo, lo), _mm512_mul_pd(hi, hi)));
+    }
+    NanSums out = {count, _mm512_reduce_add_pd(sum), _mm512_reduce_add_pd(sq)};
+    return out;
+}
+
+__attribute__((target("avx512f")))
+CrossSums crossAvx512(const float* x, const float* y, int n) {
+    __m512d sx = _mm512_setzero_pd(), sy = _mm512_setzero_pd(), sxx = _mm512_setzero_pd(),
+            syy = _mm512_setzero_pd(), sxy = _mm512_setzero_pd();
+    long long count = 0;
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 live = (n - i >= 16) ? 0xFFFF : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 xv = _mm512_maskz_loadu_ps(live, x + i), yv = _mm512_maskz_loadu_ps(live, y + i);
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(live, xv, xv, _CMP_ORD_Q), yv, yv, _CMP_ORD_Q);
+        xv = _mm512_maskz_mov_ps(ok, xv);
+        yv = _mm512_maskz_mov_ps(ok, yv);
+        count += __builtin_popcount(ok);
+        __m512d xlo = lowDoubles(xv), xhi = highDoubles(xv), ylo = lowDoubles(yv), yhi = highDoubles(yv);
+        sx = _mm512_add_pd(sx, _mm512_add_pd(xlo, xhi));
+        sy = _mm512_add_pd(sy, _mm512_add_pd(ylo, yhi));
+        sxx = _mm512_add_pd(sxx, _mm512_add_pd(_mm512_mul_pd(xlo, xlo), _mm512_mul_pd(xhi, xhi)));
+        syy = _mm512_add_pd(syy, _mm512_add_pd(_mm512_mul_pd(ylo, ylo), _mm512_mul_pd(yhi, yhi)));
+        sxy = _mm512_add_pd(sxy, _mm512_add_pd(_mm512_mul_pd(xlo, ylo), _mm512_mul_pd(xhi, yhi)));
+    }
+    CrossSums out = {count, _mm512_reduce_add_pd(sx), _mm512_reduce_add_pd(sy), _mm512_reduce_add_pd(sxx),
+                     _mm512_reduce_add_pd(syy), _mm512_reduce_add_pd(sxy)};
+    return out;
+}
+
+#endif
+
+SimdLevel cpuLevel() {
+#ifdef WEATHER_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+//-1 until the first kernel call picks the detected level
+std::atomic<int> currentLevel(-1);
+
+SimdLevel level() {
+    int l = currentLevel.load(std::memory_order_relaxed);
+    if (l < 0) {
+        l = detectSimdLevel();
+        currentLevel.store(l, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(l);
+}
+
+}
+
+NanSums nanSums(const float* data, int n) {
+    if (n <= 0) return emptySums();
+    switch (level()) {
+#ifdef WEATHER_SIMD_X86
+        case SIMD_AVX512: return sumsAvx512(data, n);
+        case SIMD_AVX2: return sumsAvx2(data, n);
+        case SIMD_SSE2: return sumsSse2(data, n);
+#endif
+        default: return sumsScalar(data, n);
+    }
+}
+
+CrossSums nanCrossSums(const float* x, const float* y, int n) {
+    if (n <= 0) return emptyCross();
+    switch (level()) {
+#ifdef WEATHER_SIMD_X86
+        case SIMD_AVX512: return crossAvx512(x, y, n);
+        case SIMD_AVX2: return crossAvx2(x, y, n);
+        case SIMD_SSE2: return crossSse2(x, y, n);
+#endif
+        default: return crossScalar(x, y, n);
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = cpuLevel();
+    return detected;
+}
+
+SimdLevel activeSimdLevel() {
+    return level();
+}
+
+SimdLevel setSimdLevel(SimdLevel wanted) {
+    SimdLevel best = detectSimdLevel();
+    SimdLevel chosen = wanted > best ? best : wanted;
+    currentLevel.store(chosen, std::memory_order_relaxed);
+    return chosen;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX512: return "avx512";
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
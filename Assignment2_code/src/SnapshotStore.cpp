@@ -0,0 +1,70 @@
+#include "SnapshotStore.h"
+#include <stdexcept>
+
+const int SnapshotStore::MAX_READERS;
+
+SnapshotStore::Reader::Reader(SnapshotStore& store) : store(store), slot(-1) {
+    for (int i = 0; i < MAX_READERS && slot < 0; i++) {
+        bool free = false;
+        if (store.slots[i].used.compare_exchange_strong(free, true)) slot = i;
+    }
+    if (slot < 0) throw std::runtime_error("Too many snapshot readers");
+}
+
+SnapshotStore::Reader::~Reader() {
+    release();
+    store.slots[slot].used.store(false);
+}
+
+//publish the epoch first, then read the pointer: a publisher that does not see
+//the pin has already swapped, so this load gets the new version
+const DataSnapshot& SnapshotStore::Reader::acquire() {
+    unsigned long long now = store.epoch.load();
+    store.slots[slot].pinned.store(now);
+    return *store.current.load();
+}
+
+void SnapshotStore::Reader::release() {
+    store.slots[slot].pinned.store(0, std::memory_order_release);
+}
+
+SnapshotStore::SnapshotStore() : current(new DataSnapshot()), currentVersion(0), epoch(1), nextVersion(1) {
+    for (int i = 0; i < MAX_READERS; i++) {
+        slots[i].used.store(false);
+        slots[i].pinned.store(0);
+    }
+}
+
+SnapshotStore::~SnapshotStore() {
+    for (int i = 0; i < retired.GetSize(); i++) delete retired[i].snapshot;
+    delete current.load();
+}
+
+void SnapshotStore::publish(DataSnapshot* next) {
+    next->version = nextVersion++;
+    const DataSnapshot* old = current.exchange(next);
+    currentVersion.store(next->version);
+    //readers pinned at this epoch or earlier may still hold the old version
+    Retired entry = {old, epoch.fetch_add(1)};
+    retired.pushBack(entry);
+    reclaim();
+}
+
+int SnapshotStore::reclaim() {
+    unsigned long long oldest = 0; //0 means no reader is pinned
+    for (int i = 0; i < MAX_READERS; i++) {
+        unsigned long long pinned = slots[i].pinned.load();
+        if (pinned != 0 && (oldest == 0 || pinned < oldest)) oldest = pinned;
+    }
+    Vector<Retired> waiting;
+    for (int i = 0; i < retired.GetSize(); i++) {
+        if (oldest == 0 || retired[i].epoch < oldest) delete retired[i].snapshot;
+        else waiting.pushBack(retired[i]);
+    }
+    retired = std::move(waiting);
+    return retired.GetSize();
+}
+
+long long SnapshotStore::GetVersion() const {
+    return currentVersion.load();
+}
@@ -0,0 +1,271 @@
+#include "TailFollower.h"
+#include "CompressedReader.h"
+#include "Parallel.h"
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+bool sameNames(const Vector<std::string>& a, const Vector<std::string>& b) {
+    if (a.GetSize() != b.GetSize()) return false;
+    for (int i = 0; i < a.GetSize(); i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+}
+
+TailFollower::TailFollower()
+    : tree(NULL), data(NULL), monthIndex(NULL), rangeIndex(NULL), fields(CORE_FIELDS), threads(1), nextId(0),
+      rangesStale(false) {}
+
+//the loaded rows are noted file by file, in the order loadDataFiles merged them
+bool TailFollower::open(BST<int>& dateTree, MonthTable<WeatherLog>& dataMap, MonthIndex& index, RangeIndex& ranges,
+                        const LoadOptions& options) {
+    Vector<std::string> names;
+    if (!FileHandler::readSourceList("data/data_source.txt", names)) {
+        std::cerr << "Could not open data_source.txt" << std::endl;
+        return false;
+    }
+    tree = &dateTree;
+    data = &dataMap;
+    monthIndex = &index;
+    rangeIndex = &ranges;
+    fields = options.fields;
+    threads = resolveThreadCount(options.threads);
+    files.Clear();
+    runs.Clear();
+    listed = names;
+    seen = names;
+    nextId = 0;
+    rangesStale = false;
+
+    //without the loader's counts the rows belong to no file and are never taken out
+    if (!options.fileRows) {
+        dataMap.forEach([this](int key, const WeatherLog& log) { addRun(key, -1, log.GetSize()); });
+    }
+    for (int i = 0; i < names.GetSize(); i++) {
+        FollowedFile file;
+        file.name = names[i];
+        file.path = "data/" + names[i];
+        file.id = nextId++;
+        bool loaded = true;
+        long long end = -1;
+        if (options.fileRows && i < options.fileRows->GetSize()) {
+            const FileRows& rows = (*options.fileRows)[i];
+            loaded = rows.loaded;
+            end = rows.end;
+            rows.rows.forEach([this, &file](int key, int n) { addRun(key, file.id, n); });
+        }
+        //compressed files are written in one go, there is nothing to follow
+        file.tail = loaded && compressionOf(file.path) == COMPRESSION_NONE && start(file, fields, end);
+        files.pushBack(std::move(file));
+    }
+    return true;
+}
+
+bool TailFollower::IsOpen() const {
+    return tree != NULL;
+}
+
+int TailFollower::GetFileCount() const {
+    int count = 0;
+    for (int i = 0; i < files.GetSize(); i++) {
+        if (files[i].tail) count++;
+    }
+    return count;
+}
+
+FollowChanges TailFollower::poll() {
+    FollowChanges changes;
+    if (!IsOpen()) return changes;
+    reloadList(changes);
+    for (int i = 0; i < files.GetSize(); i++) {
+        if (!files[i].tail) continue;
+        LoadShard appended;
+        readAppended(files[i], appended);
+        changes.added += addShard(appended, files[i].id);
+    }
+    if (rangesStale) {
+        rangeIndex->build(*data);
+        rangesStale = false;
+    }
+    return changes;
+}
+
+//each listed name keeps the first loaded file of that name not claimed yet, the rest are new
+void TailFollower::reloadList(FollowChanges& changes) {
+    Vector<std::string> names;
+    //a list that can not be read for a moment (being rewritten) changes nothing
+    if (!FileHandler::readSourceList("data/data_source.txt", names)) return;
+    if (sameNames(names, listed)) return;
+    //a new list is only taken once it reads the same twice, not while it is half written
+    if (!sameNames(names, seen)) {
+        seen = names;
+        return;
+    }
+    listed = names;
+    Vector<bool> kept(files.GetSize(), false);
+    Vector<std::string> added;
+    for (int n = 0; n < names.GetSize(); n++) {
+        int match = -1;
+        for (int i = 0; i < files.GetSize() && match < 0; i++) {
+            if (!kept[i] && files[i].name == names[n]) match = i;
+        }
+        if (match >= 0) kept[match] = true;
+        else added.pushBack(names[n]);
+    }
+
+    Vector<bool> gone(nextId, false);
+    int goneCount = 0;
+    for (int i = 0; i < files.GetSize(); i++) {
+        if (kept[i]) continue;
+        gone[files[i].id] = true;
+        goneCount++;
+        std::cerr << "No longer listed, removing: " << files[i].name << std::endl;
+    }
+    if (goneCount > 0) {
+        Vector<FollowedFile> stay;
+        for (int i = 0; i < files.GetSize(); i++) {
+            if (kept[i]) stay.pushBack(std::move(files[i]));
+        }
+        files = std::move(stay);
+        changes.removed += retract(gone);
+    }
+
+    for (int n = 0; n < added.GetSize(); n++) {
+        FollowedFile file;
+        file.name = added[n];
+        file.path = "data/" + added[n];
+        file.id = nextId++;
+        LoadShard shard;
+        long long end = 0;
+        //parsed aside first, the structures only change once the whole file is read
+        if (FileHandler::parseCSV(file.path, shard.dateTree, shard.dataMap, threads, fields, &end)) {
+            int rows = addShard(shard, file.id);
+            changes.added += rows;
+            std::cerr << "Newly listed, loaded " << rows << " readings: " << file.name << std::endl;
+            file.tail = compressionOf(file.path) == COMPRESSION_NONE && start(file, fields, end);
+        }
+        //a file that could not be read stays listed, it is tried again once it is listed anew
+        files.pushBack(std::move(file));
+    }
+}
+
+//every month with rows of a removed file is put together again from the other runs
+int TailFollower::retract(const Vector<bool>& gone) {
+    Vector<int> keys;
+    Vector<WeatherLog> rebuilt;
+    Vector<Vector<RowRun> > keptRuns;
+    int removed = 0;
+    runs.forEach([&](int key, const Vector<RowRun>& monthRuns) {
+        bool touched = false;
+        for (int r = 0; r < monthRuns.GetSize() && !touched; r++) {
+            touched = monthRuns[r].file >= 0 && gone[monthRuns[r].file];
+        }
+        if (!touched) return;
+        const WeatherLog& old = *data->find(key);
+        WeatherLog log;
+        Vector<RowRun> left;
+        int at = 0;
+        for (int r = 0; r < monthRuns.GetSize(); r++) {
+            const RowRun& run = monthRuns[r];
+            if (run.file >= 0 && gone[run.file]) {
+                removed += run.rows;
+            } else {
+                log.append(old, at, run.rows);
+                int last = left.GetSize() - 1;
+                if (last >= 0 && left[last].file == run.file) left[last].rows += run.rows;
+                else left.pushBack(run);
+            }
+            at += run.rows;
+        }
+        keys.pushBack(key);
+        rebuilt.pushBack(std::move(log));
+        keptRuns.pushBack(std::move(left));
+    });
+
+    //all months are ready, only now are the old ones replaced
+    for (int i = 0; i < keys.GetSize(); i++) {
+        int key = keys[i];
+        WeatherLog& log = (*data)[key];
+        log = std::move(rebuilt[i]);
+        runs[key] = std::move(keptRuns[i]);
+        monthIndex->update(key, log);
+        if (log.GetSize() == 0) tree->remove(key);
+    }
+    if (keys.GetSize() > 0) rangesStale = true;
+    return removed;
+}
+
+int TailFollower::addShard(LoadShard& shard, int file) {
+    int rows = 0;
+    shard.dataMap.forEach([&](int key, const WeatherLog& log) {
+        monthIndex->add(key, log);
+        addRun(key, file, log.GetSize());
+        rows += log.GetSize();
+    });
+    if (rows == 0) return 0;
+    //merging moves the shard's logs, so the range index takes them first
+    if (!rangesStale && !rangeIndex->append(shard.dataMap)) rangesStale = true;
+    FileHandler::mergeShard(shard, *tree, *data);
+    return rows;
+}
+
+void TailFollower::addRun(int key, int file, int rows) {
+    if (rows == 0) return;
+    Vector<RowRun>& monthRuns = runs[key];
+    int last = monthRuns.GetSize() - 1;
+    if (last >= 0 && monthRuns[last].file == file) {
+        monthRuns[last].rows += rows;
+        return;
+    }
+    RowRun run = {file, rows};
+    monthRuns.pushBack(run);
+}
+
+//the header gives the plan, following starts where the load stopped
+bool TailFollower::start(FollowedFile& file, FieldSet fields, long long offset) {
+    std::ifstream in(file.path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::string header;
+    //a header without its newline is still being written
+    if (!std::getline(in, header) || in.eof()) return false;
+    if (!file.plan.build(FileHandler::buildColumnMap(header), fields)) return false;
+    if (offset < 0) {
+        //nothing says where the load stopped, so go back to the last newline there is now
+        in.seekg(0, std::ios::end);
+        offset = static_cast<long long>(in.tellg());
+        while (offset > 0) {
+            in.seekg(offset - 1);
+            if (in.get() == '\n') break;
+            offset--;
+        }
+    }
+    file.offset = offset;
+    return true;
+}
+
+//reads the bytes after offset and parses up to the last newline among them
+void TailFollower::readAppended(FollowedFile& file, LoadShard& shard) {
+    std::ifstream in(file.path, std::ios::binary);
+    //a file that is missing for a moment (being rotated) is tried again next poll
+    if (!in.is_open()) return;
+    in.seekg(0, std::ios::end);
+    long long size = static_cast<long long>(in.tellg());
+    if (size == file.offset) return;
+    if (size < file.offset) {
+        std::cerr << "Data file got shorter, no longer followed: " << file.path << std::endl;
+        file.tail = false;
+        return;
+    }
+    std::string text(static_cast<std::size_t>(size - file.offset), '\0');
+    in.seekg(file.offset);
+    if (!in.read(&text[0], text.size())) return;
+    std::size_t last = text.rfind('\n');
+    if (last == std::string::npos) return;
+    FileHandler::parseRows(text.data(), text.data() + last + 1, file.plan, shard.dateTree, shard.dataMap);
+    file.offset += static_cast<long long>(last + 1);
+}
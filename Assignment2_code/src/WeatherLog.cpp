@@ -0,0 +1,166 @@
+#include "WeatherLog.h"
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+//view over a whole Vector, empty vectors give an empty view
+template<typename T>
+ColumnView<T> viewOf(const Vector<T>& column) {
+    return ColumnView<T>(column.GetData(), column.GetSize());
+}
+
+}
+
+WeatherLog::WeatherLog() {}
+
+//a log that holds the only reference can be changed in place
+WeatherLog::Columns& WeatherLog::edit() {
+    if (!columns) {
+        columns = std::make_shared<Columns>();
+    } else if (columns.use_count() > 1) {
+        columns = std::make_shared<Columns>(*columns);
+    } else {
+        //a copy dropped on another thread has finished reading before it let go
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *columns;
+}
+
+const WeatherLog::Columns& WeatherLog::read() const {
+    static const Columns empty;
+    return columns ? *columns : empty;
+}
+
+void WeatherLog::pushBack(const WeatherEntry& entry) {
+    Columns& c = edit();
+    c.stamps.pushBack(entry.minutes);
+    c.wind.pushBack(entry.windSpeed);
+    c.temp.pushBack(entry.temperature);
+    c.solar.pushBack(entry.solarRadiation);
+    if (!c.extraFields) return;
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (c.extraFields & fieldBit(f)) c.extras[f].pushBack(NAN);
+    }
+}
+
+void WeatherLog::pushBack(const WeatherEntry& entry, const float* values, FieldSet fields) {
+    fields &= ~CORE_FIELDS;
+    if ((fields & read().extraFields) != fields) addExtraColumns(fields);
+    Columns& c = edit();
+    c.stamps.pushBack(entry.minutes);
+    c.wind.pushBack(entry.windSpeed);
+    c.temp.pushBack(entry.temperature);
+    c.solar.pushBack(entry.solarRadiation);
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (c.extraFields & fieldBit(f)) c.extras[f].pushBack((fields & fieldBit(f)) ? values[f] : NAN);
+    }
+}
+
+void WeatherLog::reserve(int rows) {
+    Columns& c = edit();
+    c.stamps.reserve(rows);
+    c.wind.reserve(rows);
+    c.temp.reserve(rows);
+    c.solar.reserve(rows);
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (c.extraFields & fieldBit(f)) c.extras[f].reserve(rows);
+    }
+}
+
+void WeatherLog::append(const WeatherLog& other) {
+    append(other, 0, other.GetSize());
+}
+
+void WeatherLog::append(const WeatherLog& other, int first, int count) {
+    //other may share the columns with this log, they are read through a reference of their own
+    std::shared_ptr<Columns> keep = other.columns;
+    const Columns& from = other.read();
+    if ((from.extraFields & read().extraFields) != from.extraFields) addExtraColumns(from.extraFields);
+    //grow by doubling, a month can be appended to block after block by the loaders
+    int needed = GetSize() + count;
+    int capacity = read().stamps.GetCapacity();
+    if (needed > capacity) reserve(needed > 2 * capacity ? needed : 2 * capacity);
+    Columns& c = edit();
+    for (int i = first; i < first + count; i++) {
+        c.stamps.pushBack(from.stamps.GetData()[i]);
+        c.wind.pushBack(from.wind.GetData()[i]);
+        c.temp.pushBack(from.temp.GetData()[i]);
+        c.solar.pushBack(from.solar.GetData()[i]);
+    }
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (!(c.extraFields & fieldBit(f))) continue;
+        for (int i = first; i < first + count; i++) {
+            c.extras[f].pushBack((from.extraFields & fieldBit(f)) ? from.extras[f].GetData()[i] : NAN);
+        }
+    }
+}
+
+void WeatherLog::Clear() {
+    //shared columns stay with the other copies
+    if (!columns || columns.use_count() > 1) {
+        columns.reset();
+        return;
+    }
+    Columns& c = edit();
+    c.stamps.Clear();
+    c.wind.Clear();
+    c.temp.Clear();
+    c.solar.Clear();
+    for (int f = 0; f < FIELD_COUNT; f++) c.extras[f].Clear();
+}
+
+int WeatherLog::GetSize() const {
+    return read().stamps.GetSize();
+}
+
+WeatherEntry WeatherLog::operator[](int index) const {
+    const Columns& c = read();
+    WeatherEntry w = {c.stamps[index], c.wind[index], c.temp[index], c.solar[index]};
+    return w;
+}
+
+ColumnView<int> WeatherLog::GetTimestamps() const {
+    return viewOf(read().stamps);
+}
+
+ColumnView<float> WeatherLog::GetWindSpeeds() const {
+    return viewOf(read().wind);
+}
+
+ColumnView<float> WeatherLog::GetTemperatures() const {
+    return viewOf(read().temp);
+}
+
+ColumnView<float> WeatherLog::GetSolarRadiation() const {
+    return viewOf(read().solar);
+}
+
+FieldSet WeatherLog::GetExtraFields() const {
+    return read().extraFields;
+}
+
+ColumnView<float> WeatherLog::GetColumn(int field) const {
+    const Columns& c = read();
+    switch (field) {
+        case FIELD_S: return viewOf(c.wind);
+        case FIELD_T: return viewOf(c.temp);
+        case FIELD_SR: return viewOf(c.solar);
+        default:
+            if (field < 0 || field >= FIELD_COUNT || !(c.extraFields & fieldBit(field))) return ColumnView<float>();
+            return viewOf(c.extras[field]);
+    }
+}
+
+//new columns are padded with NaN so every column keeps one value per row
+void WeatherLog::addExtraColumns(FieldSet fields) {
+    Columns& c = edit();
+    fields &= ~CORE_FIELDS & ~c.extraFields;
+    int rows = c.stamps.GetSize();
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (!(fields & fieldBit(f))) continue;
+        c.extras[f].reserve(rows);
+        for (int i = 0; i < rows; i++) c.extras[f].pushBack(NAN);
+    }
+    c.extraFields |= fields;
+}